@@ -8,6 +8,11 @@ namespace Gaming {
     const double Advantage::ADVANTAGE_MULT_FACTOR = 2.0;
 
     Advantage::Advantage(const Game &g, const Position &p, double capacity) : Resource(g, p, capacity)
+    {
+        setTag(ADVANTAGE);
+    }
+
+    Advantage::Advantage(const Game &g, const Advantage &another) : Resource(g, another)
     {}
 
     Advantage::~Advantage()
@@ -15,32 +20,18 @@ namespace Gaming {
 
     void Advantage::print(std::ostream &os) const
     {
-        std::string str;
-        str = std::to_string(__id);
-
-
-        std::stringstream ss;
-        ss << Advantage::ADVANTAGE_ID;
-        ss << str;
-
-        std::getline(ss, str);
-
-        for (int i = 0; i < str.length(); ++i)
-        {
-            os << str[i];
-        }
+        os << Advantage::ADVANTAGE_ID << __id;
     }
 
     double Advantage::getCapacity() const
     {
-        return __capacity * ADVANTAGE_MULT_FACTOR;
+        return __rawCapacity() * ADVANTAGE_MULT_FACTOR;
     }
 
     double Advantage::consume()
     {
         double ret = getCapacity();
-        __capacity = -1;
-        finish();
+        Resource::consume();
         return ret;
     }
 
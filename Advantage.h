@@ -9,16 +9,18 @@
 #include "Resource.h"
 
 namespace Gaming {
-    class Advantage : public Resource {
-    private:
-        static const char ADVANTAGE_ID;
-
+    class Advantage final : public Resource {
     public:
+        static const char ADVANTAGE_ID; // note: the letter the piece prints as
+
         static const double ADVANTAGE_MULT_FACTOR;
 
         Advantage(const Game &g, const Position &p, double capacity);
+        Advantage(const Game &g, const Advantage &another);
         ~Advantage();
 
+        Piece *clone(const Game &g, PieceArena &arena) const override { return arena.make<Advantage>(g, *this); }
+
         PieceType getType() const override { return PieceType::ADVANTAGE; }
 
         void print(std::ostream &os) const override;
@@ -1,12 +1,14 @@
 #include "Agent.h"
-#include "Advantage.h"
-#include "Food.h"
+#include "Resource.h"
 
 namespace Gaming {
 
     const double Agent::AGENT_FATIGUE_RATE = 0.3;
 
-    Agent::Agent(const Game &g, const Position &p, double energy) : Piece(g, p), __energy(energy)
+    Agent::Agent(const Game &g, const Position &p, double energy) : Piece(g, p, true), __quiet(NO_NEIGHBORHOOD), __energy(energy)
+    {}
+
+    Agent::Agent(const Game &g, const Agent &another) : Piece(g, another), __quiet(another.__quiet), __energy(another.__energy)
     {}
 
     Agent::~Agent()
@@ -17,30 +19,29 @@ namespace Gaming {
         __energy -= AGENT_FATIGUE_RATE;
     }
 
-    Piece &Agent::operator*(Piece &other)
+    void Agent::__swapPositions(Piece &other)
     {
-        Piece *p = &other;
-        Resource *res = dynamic_cast<Resource*>(p);
-        if (res)
-        {
-            interact(res);
-        }
-        Agent *agent = dynamic_cast<Agent*>(p);
-        if (agent)
-        {
-            interact(agent);
-        }
-        if (!isFinished())
-        {
+        if (isFinished()) return;
 
-            Position pNew;
-            pNew = other.getPosition();
-            Position pOld;
-            pOld = getPosition();
-            setPosition(pNew);
-            other.setPosition(pOld);
-        }
-        return *this;
+        Position pOld = getPosition();
+        setPosition(other.getPosition());
+        other.setPosition(pOld);
+    }
+
+    Piece &Agent::fight(Piece &agent, Piece &other)
+    {
+        Agent &self = static_cast<Agent &>(agent);
+        self.interact(static_cast<Agent *>(&other));
+        self.__swapPositions(other);
+        return self;
+    }
+
+    Piece &Agent::consume(Piece &agent, Piece &resource)
+    {
+        Agent &self = static_cast<Agent &>(agent);
+        self.interact(static_cast<Resource *>(&resource));
+        self.__swapPositions(resource);
+        return self;
     }
 
     Piece &Agent::interact(Agent *other)
@@ -11,6 +11,12 @@
 namespace Gaming {
 
     class Agent : public Piece {
+        friend class SoAGrid;
+        friend class Game;  // note: lets agents without options sleep, see Game::__AgeAndDecide
+
+        NeighborhoodCode __quiet;   // the neighborhood the agent last had no option in, NO_NEIGHBORHOOD if none
+
+        void __swapPositions(Piece &other);
 
     protected:
         double __energy;
@@ -19,6 +25,7 @@ namespace Gaming {
         static const double AGENT_FATIGUE_RATE;
 
         Agent(const Game &g, const Position &p, double energy);
+        Agent(const Game &g, const Agent &another);
         ~Agent();
 
         double getEnergy() const { return __energy; }
@@ -28,10 +35,14 @@ namespace Gaming {
 
         bool isViable() const override final { return !isFinished() && __energy > 0.0; }
 
-        Piece &operator*(Piece &other) override final;
         Piece &interact(Agent *) override final;
         Piece &interact(Resource *) override final;
 
+        // interactions of an agent moving onto another agent or a resource
+        // note: the agent takes the cell of the other piece unless it loses
+        static Piece &fight(Piece &agent, Piece &other);
+        static Piece &consume(Piece &agent, Piece &resource);
+
     };
 
 }
@@ -1,5 +1,3 @@
-#include <chrono>
-#include <random>
 #include "Game.h"
 #include "AggressiveAgentStrategy.h"
 
@@ -18,76 +16,17 @@ namespace Gaming
 
     ActionType AggressiveAgentStrategy::operator()(const Surroundings &s) const
     {
-        std::vector<int> positions;
-        unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-        std::default_random_engine rnd(seed);
+        NeighborhoodMasks masks(s);
+        Random &rnd = s.rng ? *s.rng : Random::fallback();
 
-        // Check for Agent
-        if (__agentEnergy > DEFAULT_AGGRESSION_THRESHOLD)
-        {
-            for (int i = 0; i < 9; ++i) {
-                if (s.array[i] == PieceType::SIMPLE || s.array[i] == PieceType::STRATEGIC)
-                {
-                    positions.push_back(i);
-                }
-            }
-        }
-        //  Check for Advantage
-        if (positions.size() == 0) {
-            for (int i = 0; i < 9; ++i) {
-                if (s.array[i] == PieceType::ADVANTAGE)
-                {
-                    positions.push_back(i);
-                }
-            }
-        }
+        // Agent (if strong enough), then Advantage, then Empty, then Food
+        unsigned int mask = 0;
+        if (__agentEnergy > DEFAULT_AGGRESSION_THRESHOLD) mask = masks[SIMPLE] | masks[STRATEGIC];
+        if (!mask) mask = masks[ADVANTAGE];
+        if (!mask) mask = masks[EMPTY];
+        if (!mask) mask = masks[FOOD];
 
-
-        if (positions.size() == 0) {
-            for (int i = 0; i < 9; ++i)
-            {
-                if (s.array[i] == PieceType::EMPTY)
-                {
-                    positions.push_back(i);
-                }
-            }
-        }
-        //  Check for Food
-        if (positions.size() == 0)
-        {
-            for (int i = 0; i < 9; ++i)
-            {
-                if (s.array[i] == PieceType::FOOD)
-                {
-                    positions.push_back(i);
-                }
-            }
-        }
-
-
-
-        if (positions.size() > 0)
-        {
-            int posIndex = positions[rnd() % positions.size()];
-            if (positions.size() == 1) posIndex = positions[0];
-
-            ActionType ac;
-            switch (posIndex) {
-                case 0: ac = NW; break;
-                case 1: ac = N; break;
-                case 2: ac = NE; break;
-                case 3: ac = W; break;
-                case 4: ac = STAY; break;
-                case 5: ac = E; break;
-                case 6: ac = SW; break;
-                case 7: ac = S; break;
-                case 8: ac = SE; break;
-                default: ac = STAY;
-            }
-            return (ac);
-        }
-
-        return ActionType::STAY;
+        return pickAction(mask, rnd);
     }
 
 }
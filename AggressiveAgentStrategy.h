@@ -17,7 +17,11 @@ namespace Gaming {
 
         AggressiveAgentStrategy(double agentEnergy);
         ~AggressiveAgentStrategy();
+
+        double getAgentEnergy() const { return __agentEnergy; }
         ActionType operator()(const Surroundings &s) const override;
+        Strategy *clone() const override { return new AggressiveAgentStrategy(*this); }
+        bool isTypeDriven() const override { return true; }
 
     };
 
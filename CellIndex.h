@@ -0,0 +1,96 @@
+//
+// Mappings of the cells of a board onto a flat array
+//
+
+#ifndef PA5GAME_CELLINDEX_H
+#define PA5GAME_CELLINDEX_H
+
+#include <cstddef>
+
+namespace Gaming {
+
+    // Where cell (x, y) of a width x height board goes in a flat array. Row-major puts
+    // the three rows of a neighborhood a whole row apart; the tiled and Morton layouts
+    // keep most neighborhoods within a few cache lines, at the cost of some padding.
+    class CellIndex {
+    public:
+        // ROW_MAJOR: row after row, y + x * width
+        // TILED: TILE x TILE tiles row after row, each tile row-major
+        // MORTON: Z-order, the bits of the row and of the column interleaved
+        enum Layout { ROW_MAJOR, TILED, MORTON };
+
+        static const unsigned TILE = 8;
+
+    private:
+        Layout __layout;
+        unsigned __width, __height;
+        unsigned __tilesPerRow;     // TILED
+        unsigned __bits;            // MORTON: the bits interleaved, those of the shorter side (padded)
+        bool __wide;                // MORTON: the padded width is more than the padded height
+        std::size_t __size;
+
+        // the low 16 bits of v spread out to the even bits
+        static unsigned __spread(unsigned v) {
+            v &= 0xffff;
+            v = (v | v << 8) & 0x00ff00ff;
+            v = (v | v << 4) & 0x0f0f0f0f;
+            v = (v | v << 2) & 0x33333333;
+            v = (v | v << 1) & 0x55555555;
+            return v;
+        }
+
+        static unsigned __log2Ceil(unsigned n) {
+            unsigned bits = 0;
+            while ((1u << bits) < n) ++bits;
+            return bits;
+        }
+
+    public:
+        CellIndex(Layout layout = ROW_MAJOR, unsigned width = 0, unsigned height = 0) :
+                __layout(layout), __width(width), __height(height),
+                __tilesPerRow((width + TILE - 1) / TILE), __bits(0), __wide(false), __size(0)
+        {
+            switch (layout)
+            {
+                case TILED:
+                    __size = (std::size_t) __tilesPerRow * ((height + TILE - 1) / TILE) * TILE * TILE;
+                    break;
+                case MORTON:
+                {
+                    // square blocks of the shorter side, in Z-order, one after the other along the longer side
+                    unsigned widthBits = __log2Ceil(width), heightBits = __log2Ceil(height);
+                    __wide = widthBits > heightBits;
+                    __bits = __wide ? heightBits : widthBits;
+                    __size = (std::size_t) 1 << (widthBits + heightBits);
+                    break;
+                }
+                default:
+                    __size = (std::size_t) width * height;
+                    break;
+            }
+        }
+
+        Layout getLayout() const { return __layout; }
+        std::size_t size() const { return __size; }    // the length of the array, padding included
+
+        unsigned operator()(unsigned x, unsigned y) const {
+            switch (__layout)
+            {
+                case ROW_MAJOR:
+                    return y + x * __width;
+                case TILED:
+                    return ((x / TILE) * __tilesPerRow + y / TILE) * (TILE * TILE) + (x % TILE) * TILE + y % TILE;
+                default:
+                {
+                    unsigned mask = (1u << __bits) - 1;
+                    unsigned block = (__wide ? y : x) >> __bits;
+                    return (block << (2 * __bits)) | __spread(x & mask) << 1 | __spread(y & mask);
+                }
+            }
+        }
+    };
+
+}
+
+
+#endif //PA5GAME_CELLINDEX_H
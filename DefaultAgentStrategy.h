@@ -15,6 +15,8 @@ namespace Gaming {
         DefaultAgentStrategy();
         ~DefaultAgentStrategy();
         ActionType operator()(const Surroundings &s) const override;
+        Strategy *clone() const override { return new DefaultAgentStrategy(*this); }
+        bool isTypeDriven() const override { return true; }
     };
 
 }
@@ -0,0 +1,130 @@
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+#include "EventLog.h"
+#include "Snapshot.h"
+
+namespace Gaming {
+
+    const char EventLog::MAGIC[4] = { 'P', 'A', '4', 'E' };
+
+    // the most of a block read from a stream that can't tell its length at once
+    static const std::size_t CHUNK = 1 << 20;
+
+    EventLog::EventLog(std::ostream &os, unsigned int batch) :
+            __os(os), __batch(batch ? batch : 1), __numWritten(0)
+    {
+        __pending.reserve(__batch);
+
+        unsigned char header[8];
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        Snapshot::store32(header + 4, VERSION);
+        __os.write((const char *) header, sizeof(header));
+    }
+
+    EventLog::~EventLog()
+    {
+        flush();
+    }
+
+    void EventLog::record(const Event &event)
+    {
+        __pending.push_back(event);
+        if (__pending.size() == __batch) flush();
+    }
+
+    void EventLog::flush()
+    {
+        const std::size_t n = __pending.size();
+        if (n == 0) return;
+
+        // count, round, kind (padded), id, otherId, from.x, from.y, to.x, to.y, delta, otherDelta
+        const std::size_t kindBytes = (n + 3) & ~(std::size_t) 3;
+        __block.assign(4 + 4 * n + kindBytes + 6 * 4 * n + 2 * 8 * n, 0);
+
+        unsigned char *p = __block.data();
+        Snapshot::store32(p, (std::uint32_t) n);
+        p += 4;
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].round);
+        for (std::size_t i = 0; i < n; ++i) p[i] = __pending[i].kind;
+        p += kindBytes;
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].id);
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].otherId);
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].from.x);
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].from.y);
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].to.x);
+        for (std::size_t i = 0; i < n; ++i, p += 4) Snapshot::store32(p, __pending[i].to.y);
+        for (std::size_t i = 0; i < n; ++i, p += 8) Snapshot::storeDouble(p, __pending[i].delta);
+        for (std::size_t i = 0; i < n; ++i, p += 8) Snapshot::storeDouble(p, __pending[i].otherDelta);
+
+        __os.write((const char *) __block.data(), __block.size());
+        __os.flush();
+        __numWritten += n;
+        __pending.clear();
+    }
+
+    bool EventLog::read(std::istream &is, std::vector<Event> &events)
+    {
+        unsigned char header[8];
+        if (!is.read((char *) header, sizeof(header)) ||
+            std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || Snapshot::load32(header + 4) != VERSION)
+            return false;
+
+        // the bytes left in the stream, or -1 if it can't tell
+        std::streamoff left = -1;
+        const std::streampos start = is.tellg();
+        if (start != std::streampos(-1))
+        {
+            if (is.seekg(0, std::ios::end))
+            {
+                left = is.tellg() - start;
+                is.seekg(start);
+            }
+            else is.clear();
+        }
+        if (!is) return false;
+
+        std::vector<unsigned char> block;
+        unsigned char count[4];
+        while (is.read((char *) count, sizeof(count)))
+        {
+            const std::size_t n = Snapshot::load32(count);
+            const std::size_t kindBytes = (n + 3) & ~(std::size_t) 3;
+            const std::uint64_t size = (4 + 6 * 4 + 2 * 8) * (std::uint64_t) n + kindBytes;
+            if (left >= 0)
+            {
+                left -= sizeof(count);
+                if (size > (std::uint64_t) left) return false;
+                left -= (std::streamoff) size;
+            }
+            if (size > std::numeric_limits<std::size_t>::max()) return false;
+
+            // note: grown as it is read, so a count beyond what the stream holds allocates little
+            block.clear();
+            while (block.size() < size)
+            {
+                const std::size_t at = block.size();
+                block.resize(at + std::min<std::size_t>(size - at, CHUNK));
+                if (!is.read((char *) block.data() + at, block.size() - at)) return false;
+            }
+
+            const std::size_t first = events.size();
+            events.resize(first + n);
+            const unsigned char *p = block.data();
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].round = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i) events[first + i].kind = (Event::Kind) p[i];
+            p += kindBytes;
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].id = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].otherId = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].from.x = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].from.y = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].to.x = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i, p += 4) events[first + i].to.y = Snapshot::load32(p);
+            for (std::size_t i = 0; i < n; ++i, p += 8) events[first + i].delta = Snapshot::loadDouble(p);
+            for (std::size_t i = 0; i < n; ++i, p += 8) events[first + i].otherDelta = Snapshot::loadDouble(p);
+        }
+        return is.eof() && is.gcount() == 0;
+    }
+
+}
@@ -0,0 +1,88 @@
+//
+// Per-round events of a Game and a binary columnar log of them
+//
+
+#ifndef PA5GAME_EVENTLOG_H
+#define PA5GAME_EVENTLOG_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "Gaming.h"
+
+namespace Gaming {
+
+    // something that happened to a piece during a round
+    // note: aging is not an event, it happens to every piece on every round
+    struct Event {
+        // MOVE: the piece went from one cell to another
+        // FIGHT: the piece moved against an agent (otherId), the loser is REMOVEd at the end of the round
+        // CONSUME: the piece moved onto a resource (otherId) and took its capacity
+        // REMOVE: the piece left the board at the end of the round
+        enum Kind : unsigned char { MOVE = 0, FIGHT, CONSUME, REMOVE };
+
+        unsigned int round;
+        Kind kind;
+        unsigned int id;
+        unsigned int otherId;   // 0 unless FIGHT or CONSUME
+        Position from, to;      // the same cell unless MOVE, FIGHT or CONSUME
+        double delta;           // change in the energy (or raw capacity) of the piece, never below 0
+        double otherDelta;      // the same for the other piece
+    };
+
+    // receives the events of a Game as they happen, in the order of play
+    class EventSink {
+    public:
+        virtual ~EventSink() {}
+        virtual void record(const Event &event) = 0;
+        virtual void flush() {}
+    };
+
+    // Writes events to a stream in blocks of up to a batch size, so memory stays
+    // bounded however long the game runs. The stream starts with the magic "PA4E"
+    // and a version (uint32); each block is a count n (uint32) followed by the
+    // columns of its n events, one after the other:
+    //
+    //   round    uint32[n]
+    //   kind     uint8[n], padded with zeros to a multiple of 4
+    //   id       uint32[n]
+    //   otherId  uint32[n]
+    //   from.x   uint32[n], from.y uint32[n]
+    //   to.x     uint32[n], to.y   uint32[n]
+    //   delta    double[n], otherDelta double[n]
+    //
+    // All integers are little-endian, doubles are IEEE-754 bit patterns.
+    class EventLog : public EventSink {
+        std::ostream &__os;
+        unsigned int __batch;
+        unsigned long __numWritten;
+
+        std::vector<Event> __pending;
+        std::vector<unsigned char> __block;
+
+    public:
+        static const char MAGIC[4];
+        static const std::uint32_t VERSION = 1;
+        static const unsigned int DEFAULT_BATCH = 4096;
+
+        explicit EventLog(std::ostream &os, unsigned int batch = DEFAULT_BATCH);
+        EventLog(const EventLog &another) = delete;
+        EventLog &operator=(const EventLog &other) = delete;
+        ~EventLog();    // note: writes out what is pending
+
+        unsigned long getNumWritten() const { return __numWritten; }
+
+        void record(const Event &event) override;
+        void flush() override;
+
+        // read back a whole log, appending its events; false if the stream is not a complete log
+        // note: a count is checked against what is left of a seekable stream before anything is
+        // allocated for it, otherwise a block is read in bounded chunks, so a corrupt count fails cheaply
+        static bool read(std::istream &is, std::vector<Event> &events);
+    };
+
+}
+
+
+#endif //PA5GAME_EVENTLOG_H
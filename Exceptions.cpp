@@ -96,4 +96,25 @@ namespace Gaming {
     {
         setName("PosVectorEmptyEx");
     }
+
+    void UnsupportedEx::__print_args(std::ostream &os) const
+    {
+        os << "reason: " << __reason << "\n";
+    }
+
+    UnsupportedEx::UnsupportedEx(const std::string &reason) : __reason(reason)
+    {
+        setName("UnsupportedEx");
+    }
+
+    void SnapshotEx::__print_args(std::ostream &os) const
+    {
+        os << "path: " << __path << " reason: " << __reason << "\n";
+    }
+
+    SnapshotEx::SnapshotEx(const std::string &path, const std::string &reason) :
+            __path(path), __reason(reason)
+    {
+        setName("SnapshotEx");
+    }
 }
\ No newline at end of file
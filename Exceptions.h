@@ -6,6 +6,7 @@
 #define PA5GAME_EXCEPTIONS_H
 
 #include <iostream>
+#include <string>
 
 namespace Gaming {
 
@@ -76,6 +77,33 @@ namespace Gaming {
         PosVectorEmptyEx();
     };
 
+    // to use when a Game is asked for something its mode of play can't honor
+    class UnsupportedEx : public GamingException {
+    private:
+        std::string __reason;
+
+    protected:
+        void __print_args(std::ostream &os) const override;
+
+    public:
+        UnsupportedEx(const std::string &reason);
+        std::string getReason() const { return __reason; }
+    };
+
+    // to use in saving and loading of game snapshots
+    class SnapshotEx : public GamingException {
+    private:
+        std::string __path, __reason;
+
+    protected:
+        void __print_args(std::ostream &os) const override;
+
+    public:
+        SnapshotEx(const std::string &path, const std::string &reason);
+        std::string getPath() const { return __path; }
+        std::string getReason() const { return __reason; }
+    };
+
 }
 
 
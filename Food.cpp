@@ -8,6 +8,11 @@ namespace Gaming {
     const char Food::FOOD_ID = 'F';
 
     Food::Food(const Game &g, const Position &p, double capacity) : Resource(g, p, capacity)
+    {
+        setTag(FOOD);
+    }
+
+    Food::Food(const Game &g, const Food &another) : Resource(g, another)
     { }
 
     Food::~Food()
@@ -15,15 +20,6 @@ namespace Gaming {
 
     void Food::print(std::ostream &os) const
     {
-        std::string str;
-        str = std::to_string(__id);
-        std::stringstream ss;
-        ss << Food::FOOD_ID;
-        ss << str;
-        std::getline(ss, str);
-        for (int i = 0; i < str.length(); ++i)
-        {
-            os << str[i];
-        }
+        os << Food::FOOD_ID << __id;
     }
 }
\ No newline at end of file
@@ -10,14 +10,16 @@
 
 namespace Gaming {
 
-    class Food : public Resource {
-    private:
-        static const char FOOD_ID;
-
+    class Food final : public Resource {
     public:
+        static const char FOOD_ID; // note: the letter the piece prints as
+
         Food(const Game &g, const Position &p, double capacity);
+        Food(const Game &g, const Food &another);
         ~Food();
 
+        Piece *clone(const Game &g, PieceArena &arena) const override { return arena.make<Food>(g, *this); }
+
         PieceType getType() const override { return PieceType::FOOD; }
 
         void print(std::ostream &os) const override;
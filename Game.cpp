@@ -1,11 +1,20 @@
 #include <sstream>
 #include <iomanip>
-#include <set>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <memory>
 #include "Game.h"
 #include "Simple.h"
 #include "Strategic.h"
 #include "Food.h"
 #include "Advantage.h"
+#include "PieceVisitor.h"
+#include "SoAGrid.h"
+#include "SparseGrid.h"
+#include "Snapshot.h"
+#include "AggressiveAgentStrategy.h"
 
 namespace Gaming
 {
@@ -14,63 +23,77 @@ namespace Gaming
     const unsigned int Game::NUM_INIT_RESOURCE_FACTOR = 2;
     const unsigned Game::MIN_WIDTH = 3;
     const unsigned Game::MIN_HEIGHT = 3;
+    const unsigned Game::STRIPE_ROWS = 4;
+    const unsigned Game::SORT_LIVE_FACTOR = 16;
     const double Game::STARTING_AGENT_ENERGY = 20;
     const double Game::STARTING_RESOURCE_CAPACITY = 10;
 
     PositionRandomizer Game::__posRandomizer = PositionRandomizer();
 
+    DefaultAgentStrategy Game::__defaultStrategy;
+
     void Game::populate()  // populate the grid (used in automatic random initialization of a Game)
     {
-        std::default_random_engine gen;
+        populate(NUM_INIT_AGENT_FACTOR, NUM_INIT_RESOURCE_FACTOR);
+    }
+
+    void Game::populate(unsigned agentFactor, unsigned resourceFactor)
+    {
         std::uniform_int_distribution<int> d(0, __width * __height);
 
-        __numInitAgents = (__width * __height) / NUM_INIT_AGENT_FACTOR;
-        __numInitResources = (__width * __height) / NUM_INIT_RESOURCE_FACTOR;
+        // note: a zero factor places none, and what doesn't fit on the free cells is left out
+        unsigned int numFree = __width * __height - getNumPieces();
+        __numInitAgents = std::min(agentFactor ? (__width * __height) / agentFactor : 0, numFree);
+        __numInitResources = std::min(resourceFactor ? (__width * __height) / resourceFactor : 0,
+                                      numFree - __numInitAgents);
         unsigned int numStrategic = __numInitAgents / 2;
         unsigned int numSimple = __numInitAgents - numStrategic;
         unsigned int numAdvantages = __numInitResources / 4;
         unsigned int numFoods = __numInitResources - numAdvantages;
 
+        __arena.reserve(__numInitAgents + __numInitResources,
+                        std::max(std::max(sizeof(Simple), sizeof(Strategic)), std::max(sizeof(Food), sizeof(Advantage))));
+
         while (numStrategic > 0)
         {
-            int i = d(gen);
-            if (i != (__width * __height) && __grid[i] == nullptr)
+            int i = d(__rng);
+            if (i != (__width * __height) && !__at(i / __width, i % __width))
             {
                 Position pos(i / __width, i % __width);
-                __grid[i] = new Strategic(*this, pos, STARTING_AGENT_ENERGY);
+                __setCell(__arena.make<Strategic>(*this, pos, STARTING_AGENT_ENERGY, &__defaultStrategy, false));
                 numStrategic--;
             }
         }
 
         while (numSimple > 0)
         {
-            int i = d(gen);
-            if (i != (__width * __height) && __grid[i] == nullptr)
+            int i = d(__rng);
+            if (i != (__width * __height) && !__at(i / __width, i % __width))
             {
                 Position pos(i / __width, i % __width);
-                __grid[i] = new Simple(*this, pos, STARTING_AGENT_ENERGY);
+                __setCell(__arena.make<Simple>(*this, pos, STARTING_AGENT_ENERGY));
                 numSimple--;
             }
         }
 
         while (numFoods > 0)
         {
-            int i = d(gen);
-            if (i != (__width * __height) && __grid[i] == nullptr)
+            int i = d(__rng);
+            if (i != (__width * __height) && !__at(i / __width, i % __width))
             {
                 Position pos(i / __width, i % __width);
-                __grid[i] = new Food(*this, pos, STARTING_RESOURCE_CAPACITY);
+                __setCell(__arena.make<Food>(*this, pos, STARTING_RESOURCE_CAPACITY));
                 numFoods--;
             }
         }
 
         while (numAdvantages > 0)
         {
-            int i = d(gen);
-            if (i != (__width * __height) && __grid[i] == nullptr)
+            int i = d(__rng);
+            if (i != (__width * __height) && !__at(i / __width, i % __width))
             {
                 Position pos(i / __width, i % __width);
-                __grid[i] = new Advantage(*this, pos, STARTING_RESOURCE_CAPACITY);
+                __setCell(__arena.make<Advantage>(*this, pos, STARTING_RESOURCE_CAPACITY));
                 numAdvantages--;
             }
         }
@@ -78,19 +101,44 @@ namespace Gaming
 
     //PUBLIC
     //Constructors / Destructor
-    Game::Game() : __width(3), __height(3)
+    Game::Game() :
+            __width(3), __height(3), __index(CellIndex::ROW_MAJOR, 3, 3), __layout(CellIndex::ROW_MAJOR),
+            __backend(OBJECT_GRID), __soa(nullptr), __soaStale(false), __sparse(nullptr),
+            __rng(std::random_device{}()), __pool(nullptr), __update(SEQUENTIAL),
+            __interactions(Piece::DEFAULT_INTERACTIONS), __fastForward(false), __sink(nullptr)
     {
+        __numPieces.fill(0);
         for (unsigned i = 0; i < (__width * __height); ++i)
         {
             __grid.push_back(nullptr);
         }
+        __encodeNeighborhoods();
         __status = NOT_STARTED;
         __verbose = false;
         __round = 0;
+        __ticks = 0;
+    }
+
+    Game::Game(unsigned width, unsigned height, bool manual) :
+            Game(width, height, manual, std::random_device{}())
+    { }
+
+    Game::Game(unsigned width, unsigned height, bool manual, unsigned int seed) :
+            Game(width, height, OBJECT_GRID, seed)
+    {
+        if (!manual)
+        {
+            populate();
+        }
     }
 
-    Game::Game(unsigned width, unsigned height, bool manual) : __width(width), __height(height)
+    Game::Game(unsigned width, unsigned height, Backend backend, unsigned int seed) :
+            __width(width), __height(height), __index(CellIndex::ROW_MAJOR, width, height),
+            __layout(CellIndex::ROW_MAJOR), __backend(OBJECT_GRID), __soa(nullptr), __soaStale(false),
+            __sparse(nullptr), __rng(seed), __pool(nullptr), __update(SEQUENTIAL),
+            __interactions(Piece::DEFAULT_INTERACTIONS), __fastForward(false), __sink(nullptr)
     {
+        __numPieces.fill(0);
         if (width < MIN_WIDTH || height < MIN_HEIGHT)
         {
             throw InsufficientDimensionsEx(MIN_WIDTH, MIN_HEIGHT, width, height);
@@ -99,196 +147,690 @@ namespace Gaming
         __status = NOT_STARTED;
         __verbose = false;
         __round = 0;
+        __ticks = 0;
 
-        for (unsigned i = 0; i < (__width * __height); ++i)
+        if (backend == SPARSE_GRID)
         {
-            __grid.push_back(nullptr);
+            __sparse = new SparseGrid(); // note: the board is never allocated in full
+            __backend = SPARSE_GRID;
+        }
+        else
+        {
+            __grid.assign(__index.size(), nullptr);
+            __encodeNeighborhoods();
+            setBackend(backend);
         }
+    }
 
-        if (!manual)
+    Game::Game(const Game &another) :
+            __numInitAgents(another.__numInitAgents), __numInitResources(another.__numInitResources),
+            __width(another.__width), __height(another.__height),
+            __grid(another.__grid.size(), nullptr), __index(another.__index), __layout(another.__layout),
+            __backend(OBJECT_GRID), __soa(nullptr), __soaStale(false), __sparse(nullptr),
+            __scheduler(another.__scheduler.getOrder()), __rng(another.__rng), __pool(nullptr),
+            __update(another.__update), __interactions(another.__interactions),
+            __fastForward(another.__fastForward), __sink(nullptr),
+            __round(another.__round), __ticks(another.__ticks), __status(another.__status),
+            __verbose(another.__verbose)
+    {
+        another.__syncPieces();
+
+        __numPieces.fill(0);
+        __arena.reserve(another.getNumPieces(),
+                        std::max(std::max(sizeof(Simple), sizeof(Strategic)), std::max(sizeof(Food), sizeof(Advantage))));
+        try
         {
-            populate();
+            if (another.__sparse)
+            {
+                __sparse = new SparseGrid();
+                __backend = SPARSE_GRID;
+            }
+            else
+            {
+                __encodeNeighborhoods();
+            }
+            std::vector<Piece *> pieces;
+            another.__listPieces(pieces);
+            for (auto it = pieces.begin(); it != pieces.end(); ++it)
+                __setCell((*it)->clone(*this, __arena));
+
+            setNumThreads(another.getNumThreads());
+            setBackend(another.__backend);
+        }
+        catch (...)
+        {
+            __release();    // note: no destructor for a Game which was never built
+            throw;
+        }
+    }
+
+    Game Game::fork(unsigned int branch) const
+    {
+        Game branched(*this);
+        branched.__rng = __rng.split(~__round, branch); // note: apart from the streams of the board stripes
+        return branched;
+    }
+
+    Game::Game(const std::string &snapshot) :
+            __numInitAgents(0), __numInitResources(0), __layout(CellIndex::ROW_MAJOR),
+            __backend(OBJECT_GRID), __soa(nullptr), __soaStale(false), __sparse(nullptr),
+            __rng(0), __pool(nullptr), __update(SEQUENTIAL), __interactions(Piece::DEFAULT_INTERACTIONS),
+            __fastForward(false), __sink(nullptr), __verbose(false)
+    {
+        Snapshot s(snapshot);
+
+        __width = s.getWidth();
+        __height = s.getHeight();
+        if (__width < MIN_WIDTH || __height < MIN_HEIGHT)
+        {
+            throw InsufficientDimensionsEx(MIN_WIDTH, MIN_HEIGHT, __width, __height);
+        }
+        if (s.getStatus() > OVER || s.getBackend() > SPARSE_GRID || s.getTurnOrder() > TurnScheduler::SHUFFLED ||
+            s.getUpdate() > SYNCHRONOUS || s.getLayout() > CellIndex::MORTON)
+        {
+            throw SnapshotEx(snapshot, "bad header");
+        }
+        __round = s.getRound();
+        __ticks = __round;
+        __status = (Status) s.getStatus();
+        __scheduler.setOrder((TurnScheduler::Order) s.getTurnOrder());
+        __update = (Update) s.getUpdate();
+        __rng.seed(s.getSeed());
+        if (!__rng.setState(s.getRandomState()))
+        {
+            throw SnapshotEx(snapshot, "bad random state");
+        }
+
+        __numPieces.fill(0);
+        unsigned int maxId = 0;
+        try
+        {
+            if (s.getBackend() == SPARSE_GRID)
+            {
+                __sparse = new SparseGrid();
+                __backend = SPARSE_GRID;
+            }
+            else
+            {
+                __layout = (CellIndex::Layout) s.getLayout();
+                __index = CellIndex((s.getBackend() == SOA_GRID) ? CellIndex::ROW_MAJOR : __layout, __width, __height);
+                __grid.assign(__index.size(), nullptr);
+                __encodeNeighborhoods();
+            }
+            __arena.reserve(s.getNumRecords(),
+                            std::max(std::max(sizeof(Simple), sizeof(Strategic)), std::max(sizeof(Food), sizeof(Advantage))));
+
+            for (unsigned r = 0; r < s.getNumRecords(); ++r)
+            {
+                const unsigned char *record = s.getRecord(r);
+                unsigned index = Snapshot::load32(record);
+                double value = Snapshot::loadDouble(record + 16);
+                if (index >= (std::uint64_t) __width * __height || __at(index / __width, index % __width))
+                    throw SnapshotEx(snapshot, "bad record");
+
+                Position pos(index / __width, index % __width);
+                Piece *piece;
+                switch (record[8])
+                {
+                    case SIMPLE: piece = __arena.make<Simple>(*this, pos, value); break;
+                    case FOOD: piece = __arena.make<Food>(*this, pos, value); break;
+                    case ADVANTAGE: piece = __arena.make<Advantage>(*this, pos, value); break;
+                    case STRATEGIC:
+                        if (record[9] == Snapshot::DEFAULT_STRATEGY)
+                        {
+                            piece = __arena.make<Strategic>(*this, pos, value, &__defaultStrategy, false);
+                            break;
+                        }
+                        if (record[9] == Snapshot::AGGRESSIVE_STRATEGY)
+                        {
+                            // note: owned by the piece once it is made
+                            std::unique_ptr<Strategy> strategy(
+                                    new AggressiveAgentStrategy(Snapshot::loadDouble(record + 24)));
+                            piece = __arena.make<Strategic>(*this, pos, value, strategy.get());
+                            strategy.release();
+                            break;
+                        }
+                        // fall through
+                    default:
+                        throw SnapshotEx(snapshot, "bad record");
+                }
+                piece->__id = Snapshot::load32(record + 4);
+                maxId = std::max(maxId, piece->__id);
+                __setCell(piece);
+            }
+
+            setBackend((Backend) s.getBackend());
         }
+        catch (...)
+        {
+            __release();    // note: no destructor for a Game which was never built
+            throw;
+        }
+
+        // new pieces must not reuse the ids of the loaded ones
+        unsigned int next = Piece::__idGen;
+        while (next <= maxId && !Piece::__idGen.compare_exchange_weak(next, maxId + 1));
     }
 
     Game::~Game()
+    {
+        __release();
+    }
+
+    void Game::__release()
+    {
+        __destroyAll();
+        delete __soa;
+        delete __sparse;
+        delete __pool;
+        __soa = nullptr;
+        __sparse = nullptr;
+        __pool = nullptr;
+    }
+
+    void Game::__destroyAll()
     {
         for (auto it = __grid.begin(); it != __grid.end(); ++it)
         {
             if (*it != nullptr)
             {
-                delete *it;
+                __arena.destroy(*it);
+                *it = nullptr;
             }
         }
+        if (__sparse)
+        {
+            std::vector<Piece *> pieces;
+            __sparse->collect(pieces);
+            for (auto it = pieces.begin(); it != pieces.end(); ++it) __arena.destroy(*it);
+            __sparse->clear();
+        }
+        __live.clear();
+        __spoiling.clear();
     }
 
-    // Accessors
-    unsigned int Game::getNumPieces() const
+    void Game::save(const std::string &path) const
     {
-        unsigned int numPieces = 0;
-        for (auto it = __grid.begin(); it != __grid.end(); ++it)
+        __syncPieces();
+        if ((std::uint64_t) __width * __height > (std::uint64_t) UINT32_MAX + 1)
         {
-            if (*it != nullptr)
-                numPieces++;
+            throw SnapshotEx(path, "board too large"); // note: cell indices are 32-bit
         }
+        if (__customInteractions())
+        {
+            throw SnapshotEx(path, "custom interactions");
+        }
+
+        std::vector<Piece *> pieces;
+        __listPieces(pieces);
+
+        std::string state = __rng.getState();
+        std::size_t recordsAt = Snapshot::HEADER_SIZE + Snapshot::padded(state.size());
+        std::vector<unsigned char> bytes(recordsAt + getNumPieces() * Snapshot::RECORD_SIZE, 0);
 
-        return numPieces;
+        unsigned char *header = bytes.data();
+        std::memcpy(header, Snapshot::MAGIC, sizeof(Snapshot::MAGIC));
+        Snapshot::store32(header + 4, Snapshot::VERSION);
+        Snapshot::store32(header + 8, __width);
+        Snapshot::store32(header + 12, __height);
+        Snapshot::store32(header + 16, __round);
+        Snapshot::store32(header + 20, getNumPieces());
+        header[24] = (unsigned char) __status;
+        header[25] = (unsigned char) __backend;
+        header[26] = (unsigned char) __scheduler.getOrder();
+        header[27] = (unsigned char) __update;
+        header[36] = (unsigned char) __layout;
+        Snapshot::store32(header + 28, __rng.getSeed());
+        Snapshot::store32(header + 32, (std::uint32_t) state.size());
+        std::memcpy(header + Snapshot::HEADER_SIZE, state.data(), state.size());
+
+        unsigned char *record = bytes.data() + recordsAt;
+        for (auto it = pieces.begin(); it != pieces.end(); ++it)
+        {
+            const Piece *piece = *it;
+
+            PieceType type = piece->getType();
+            Snapshot::store32(record, piece->getPosition().y + piece->getPosition().x * __width);
+            Snapshot::store32(record + 4, piece->getId());
+            record[8] = (unsigned char) type;
+            if (type == SIMPLE || type == STRATEGIC)
+            {
+                Snapshot::storeDouble(record + 16, static_cast<const Agent *>(piece)->getEnergy());
+            }
+            else
+            {
+                Snapshot::storeDouble(record + 16, static_cast<const Resource *>(piece)->__rawCapacity());
+            }
+            if (type == STRATEGIC)
+            {
+                const Strategy *strategy = static_cast<const Strategic *>(piece)->getStrategy();
+                const AggressiveAgentStrategy *aggressive = dynamic_cast<const AggressiveAgentStrategy *>(strategy);
+                if (aggressive)
+                {
+                    record[9] = Snapshot::AGGRESSIVE_STRATEGY;
+                    Snapshot::storeDouble(record + 24, aggressive->getAgentEnergy());
+                }
+                else if (dynamic_cast<const DefaultAgentStrategy *>(strategy))
+                {
+                    record[9] = Snapshot::DEFAULT_STRATEGY;
+                }
+                else
+                {
+                    throw SnapshotEx(path, "strategy cannot be saved");
+                }
+            }
+            record += Snapshot::RECORD_SIZE;
+        }
+
+        Snapshot::write(path, bytes);
     }
 
-    unsigned int Game::getNumAgents() const
+    Piece *Game::__at(unsigned x, unsigned y) const
     {
-        unsigned int numAgents = 0;
+        return __sparse ? __sparse->get(x, y) : __grid[__index(x, y)];
+    }
 
-        for (auto it = __grid.begin(); it != __grid.end(); ++it)
+    void Game::__put(unsigned x, unsigned y, Piece *piece)
+    {
+        if (__sparse)
         {
-            Agent *simple = dynamic_cast<Agent*>(*it);
-            if (simple) numAgents++;
+            __sparse->set(x, y, piece);
+            return;
         }
+        __grid[__index(x, y)] = piece;
+        if (!__codes.empty()) __recode(x, y, piece ? piece->getType() : EMPTY);
+    }
 
-        return numAgents;
+    // A cell is in the neighborhood codes of the 8 cells around it, each time in the opposite
+    // direction: writing its new type there keeps every code up to date in 8 stores. The cells
+    // on the edge write into the ring around the board, so there are no bounds to check.
+    // note: the stripes of a parallel round are far enough apart not to write the same codes
+    void Game::__recode(unsigned x, unsigned y, PieceType type)
+    {
+        static constexpr struct { int dx, dy; unsigned shift; } around[8] = {
+                { -1, -1, 21 }, { -1, 0, 18 }, { -1, 1, 15 }, { 0, -1, 12 },
+                { 0, 1, 9 }, { 1, -1, 6 }, { 1, 0, 3 }, { 1, 1, 0 } };
+
+        const int stride = (int) __width + 2;
+        NeighborhoodCode *center = &__codes[__codeIndex(x, y)];
+        for (unsigned k = 0; k < 8; ++k)
+        {
+            NeighborhoodCode &code = center[around[k].dx * stride + around[k].dy];
+            code = (code & ~((NeighborhoodCode) 7 << around[k].shift)) | (NeighborhoodCode) type << around[k].shift;
+        }
     }
 
-    unsigned int Game::getNumSimple() const
+    void Game::__encodeNeighborhoods()
     {
-        unsigned int numAgents = 0;
+        std::vector<unsigned char> padded((std::size_t) (__width + 2) * (__height + 2), INACCESSIBLE);
+        for (unsigned x = 0; x < __height; ++x)
+            for (unsigned y = 0; y < __width; ++y)
+            {
+                const Piece *piece = __grid[__index(x, y)];
+                padded[(x + 1) * (__width + 2) + y + 1] = (unsigned char) (piece ? piece->getType() : EMPTY);
+            }
+        // note: row by row, each one between the rows of the ring
+        __codes.resize((std::size_t) (__width + 2) * (__height + 2));
+        for (unsigned x = 0; x < __height; ++x)
+            encodeNeighborhoods(&padded[x * (__width + 2)], __width, 1, &__codes[__codeIndex(x, 0)]);
+    }
 
-        for (auto it = __grid.begin(); it != __grid.end(); ++it)
+    void Game::__setCell(Piece *piece)
+    {
+        Position pos = piece->getPosition();
+        __put(pos.x, pos.y, piece);
+        if (!piece->isMobile())
         {
-            Simple *simple = dynamic_cast<Simple*>(*it);
-            if (simple) numAgents ++;
+            Resource *resource = static_cast<Resource *>(piece);
+            resource->__expiry = __expiryOf(resource);
+            __spoiling.add(piece, resource->__expiry);
         }
+        else
+        {
+            piece->__slot = (unsigned) __live.size();
+            __live.push_back(piece);
+        }
+        ++__numPieces[piece->getType()];
+        if (__soa) __soa->place(pos.y + pos.x * __width, piece);
+    }
 
-        return numAgents;
+    unsigned Game::__expiryOf(const Resource *resource) const
+    {
+        // note: from birth, as the resource spoils (see Resource::__rawCapacity)
+        unsigned limit = std::numeric_limits<unsigned>::max() - resource->__born;
+        return std::max(resource->__born + __roundsLeft(resource->__capacity, Resource::RESOURCE_SPOIL_FACTOR, limit),
+                        __ticks + 1);
     }
 
-    unsigned int Game::getNumStrategic() const
+    void Game::__respoil(Resource *resource) const
     {
-        unsigned int numAgents = 0;
+        Position pos = resource->getPosition();
+        if (pos.x >= __height || pos.y >= __width || __at(pos.x, pos.y) != resource) return;
 
-        for (auto it = __grid.begin(); it != __grid.end(); ++it)
+        __spoiling.remove(resource, resource->__expiry);
+        resource->__expiry = __expiryOf(resource);
+        __spoiling.add(resource, resource->__expiry);
+    }
+
+    bool Game::__inGridOrder(const Piece *a, const Piece *b)
+    {
+        Position pa = a->getPosition(), pb = b->getPosition();
+        return pa.x < pb.x || (pa.x == pb.x && pa.y < pb.y);
+    }
+
+    void Game::__listPieces(std::vector<Piece *> &pieces, bool withImmobile) const
+    {
+        // few pieces on a big board: sorting them is cheaper than looking at every cell
+        std::size_t first = pieces.size();
+        std::size_t numListed = __live.size() + (withImmobile ? __spoiling.size() : 0);
+        if ((std::uint64_t) numListed * SORT_LIVE_FACTOR < (std::uint64_t) __width * __height)
         {
-            Strategic *simple = dynamic_cast<Strategic*>(*it);
-            if (simple) numAgents ++;
+            pieces.insert(pieces.end(), __live.begin(), __live.end());
+            if (withImmobile) __spoiling.collectAll(pieces);
+            std::sort(pieces.begin() + first, pieces.end(), __inGridOrder);
+            return;
         }
+        if (__sparse)
+        {
+            __sparse->collect(pieces);
+        }
+        else
+        {
+            for (unsigned x = 0; x < __height; ++x)
+                for (unsigned y = 0; y < __width; ++y)
+                    if (Piece *piece = __grid[__index(x, y)]) pieces.push_back(piece);
+        }
+        if (!withImmobile)
+            pieces.erase(std::remove_if(pieces.begin() + first, pieces.end(), [](const Piece *piece) {
+                return !piece->isMobile();
+            }), pieces.end());
+    }
+
+    void Game::__relayout(CellIndex::Layout layout)
+    {
+        if (layout == __index.getLayout()) return;
 
-        return numAgents;
+        CellIndex index(layout, __width, __height);
+        std::vector<Piece *> grid(index.size(), nullptr);
+        for (unsigned x = 0; x < __height; ++x)
+            for (unsigned y = 0; y < __width; ++y)
+                grid[index(x, y)] = __grid[__index(x, y)];
+        __grid.swap(grid);
+        __index = index;
     }
 
-    unsigned int Game::getNumResources() const
+    void Game::setLayout(CellIndex::Layout layout)
     {
-        unsigned int numAgents = 0;
+        __layout = layout;
+        if (__backend == OBJECT_GRID) __relayout(layout);
+    }
 
-        for (auto it = __grid.begin(); it != __grid.end(); ++it)
+    void Game::__destroy(Piece *piece)
+    {
+        --__numPieces[piece->getType()];
+
+        if (!piece->isMobile())
         {
-            Resource *simple = dynamic_cast<Resource*>(*it);
-            if (simple) numAgents++;
+            __spoiling.remove(piece, static_cast<Resource *>(piece)->__expiry);
         }
+        else
+        {
+            // swap-remove from the live list
+            Piece *last = __live.back();
+            __live[piece->__slot] = last;
+            last->__slot = piece->__slot;
+            __live.pop_back();
+        }
+
+        __arena.destroy(piece);
+    }
+
+    Piece *Game::__makeStrategic(const Position &position, Strategy *s)
+    {
+        if (s) return __arena.make<Strategic>(*this, position, STARTING_AGENT_ENERGY, s);
+        return __arena.make<Strategic>(*this, position, STARTING_AGENT_ENERGY, &__defaultStrategy, false);
+    }
+
+    void Game::__syncPieces() const
+    {
+        if (__soa && __soaStale)
+        {
+            __soa->store(__grid);
+            __soaStale = false;
+        }
+    }
+
+    void Game::setNumThreads(unsigned numThreads)
+    {
+        if (numThreads == getNumThreads()) return;
+
+        delete __pool;
+        __pool = (numThreads > 1) ? new ThreadPool(numThreads) : nullptr;
+    }
+
+    bool Game::__customInteractions() const
+    {
+        return __interactions != Piece::DEFAULT_INTERACTIONS;
+    }
+
+    Interaction Game::getInteraction(PieceType type, PieceType otherType) const
+    {
+        if (type >= INACCESSIBLE || otherType >= INACCESSIBLE)
+        {
+            throw UnsupportedEx("interactions are between actual pieces");
+        }
+        return __interactions[type][otherType];
+    }
+
+    void Game::setInteraction(PieceType type, PieceType otherType, Interaction interaction)
+    {
+        if (type >= INACCESSIBLE || otherType >= INACCESSIBLE)
+        {
+            throw UnsupportedEx("interactions are between actual pieces");
+        }
+        if (interaction == nullptr)
+        {
+            throw UnsupportedEx("an interaction can't be null");
+        }
+        if (interaction != Piece::DEFAULT_INTERACTIONS[type][otherType] &&
+            (__backend == SOA_GRID || __update == SYNCHRONOUS))
+        {
+            throw UnsupportedEx("SOA_GRID and SYNCHRONOUS rounds play by the default interactions");
+        }
+        __interactions[type][otherType] = interaction;
+    }
+
+    void Game::setUpdate(Update update)
+    {
+        if (update == SYNCHRONOUS && __customInteractions())
+        {
+            throw UnsupportedEx("SYNCHRONOUS rounds play by the default interactions");
+        }
+        __update = update;
+    }
+
+    void Game::setBackend(Backend backend)
+    {
+        if (backend == __backend) return;
+        if (backend == SOA_GRID && __customInteractions())
+        {
+            throw UnsupportedEx("the SOA_GRID backend plays by the default interactions");
+        }
+
+        // back to the object grid first
+        if (__soa)
+        {
+            __syncPieces();
+            delete __soa;
+            __soa = nullptr;
+        }
+        if (__sparse)
+        {
+            std::vector<Piece *> pieces;
+            __sparse->collect(pieces);
+            __index = CellIndex(__layout, __width, __height);
+            __grid.assign(__index.size(), nullptr);
+            delete __sparse;
+            __sparse = nullptr;
+            for (auto it = pieces.begin(); it != pieces.end(); ++it)
+                __put((*it)->getPosition().x, (*it)->getPosition().y, *it);
+        }
+
+        if (backend == SOA_GRID)
+        {
+            __relayout(CellIndex::ROW_MAJOR); // note: the planes and the grid are indexed alike
+            __soa = new SoAGrid(__width, __height);
+            __soa->load(__grid);
+        }
+        else if (backend == SPARSE_GRID)
+        {
+            std::vector<Piece *> pieces;
+            __listPieces(pieces);
+            std::vector<Piece *>().swap(__grid);
+            __sparse = new SparseGrid();
+            for (auto it = pieces.begin(); it != pieces.end(); ++it)
+                __put((*it)->getPosition().x, (*it)->getPosition().y, *it);
+        }
+        else
+        {
+            __relayout(__layout);
+        }
+
+        if (backend == OBJECT_GRID) __encodeNeighborhoods();
+        else std::vector<NeighborhoodCode>().swap(__codes);
+        __backend = backend;
+    }
+
+    // Accessors
+    unsigned int Game::getNumPieces() const
+    {
+        return __numPieces[SIMPLE] + __numPieces[STRATEGIC] + __numPieces[FOOD] + __numPieces[ADVANTAGE];
+    }
+
+    unsigned int Game::getNumAgents() const
+    {
+        return __numPieces[SIMPLE] + __numPieces[STRATEGIC];
+    }
+
+    unsigned int Game::getNumSimple() const
+    {
+        return __numPieces[SIMPLE];
+    }
 
-        return numAgents;
+    unsigned int Game::getNumStrategic() const
+    {
+        return __numPieces[STRATEGIC];
+    }
+
+    unsigned int Game::getNumResources() const
+    {
+        return __numPieces[FOOD] + __numPieces[ADVANTAGE];
     }
 
     const Piece *Game::getPiece(unsigned int x, unsigned int y) const
     {
         if (y >= __width || x >= __height) throw OutOfBoundsEx(__width, __height, x, y);
-        if (__grid[y + (x * __width)] == nullptr) throw PositionEmptyEx(x, y);
-        return __grid[y + (x * __width)];
+        Piece *piece = __at(x, y);
+        if (piece == nullptr) throw PositionEmptyEx(x, y);
+        __syncPieces();
+        return piece;
     }
 
     // grid population methods
     void Game::addSimple(const Position &position)
     {
-        int index = position.y + (position.x * __width);
         if (position.y >= __width || position.x >= __height) throw OutOfBoundsEx(__width, __height, position.x, position.y);
-        if (__grid[index]) throw PositionNonemptyEx(position.x, position.y);
+        if (__at(position.x, position.y)) throw PositionNonemptyEx(position.x, position.y);
 
-        __grid[index] = new Simple(*this, position, STARTING_AGENT_ENERGY);
+        __setCell(__arena.make<Simple>(*this, position, STARTING_AGENT_ENERGY));
     }
 
     void Game::addSimple(const Position &position, double energy)  // used for testing only
     {
-        int index = position.y + (position.x * __width);
         if (position.y >= __width || position.x >= __height) throw OutOfBoundsEx(__width, __height, position.x, position.y);
-        if (__grid[index]) throw PositionNonemptyEx(position.x, position.y);
+        if (__at(position.x, position.y)) throw PositionNonemptyEx(position.x, position.y);
 
-        __grid[index] = new Simple(*this, position, energy);
+        __setCell(__arena.make<Simple>(*this, position, energy));
     }
 
     void Game::addSimple(unsigned x, unsigned y)
     {
-        int index = y + (x * __width);
         if (y >= __width || x >= __height) throw OutOfBoundsEx(__width, __height, x, y);
-        if (__grid[index]) throw PositionNonemptyEx(x, y);
+        if (__at(x, y)) throw PositionNonemptyEx(x, y);
 
-        __grid[index] = new Simple(*this, Position(x, y), STARTING_AGENT_ENERGY);
+        __setCell(__arena.make<Simple>(*this, Position(x, y), STARTING_AGENT_ENERGY));
     }
 
     void Game::addSimple(unsigned y, unsigned x, double energy)
     {
-        int index = y + (x * __width);
         if (y >= __width || x >= __height) throw OutOfBoundsEx(__width, __height, x, y);
-        if (__grid[index]) throw PositionNonemptyEx(x, y);
+        if (__at(x, y)) throw PositionNonemptyEx(x, y);
 
-        __grid[index] = new Simple(*this, Position(x, y), energy);
+        __setCell(__arena.make<Simple>(*this, Position(x, y), energy));
     }
 
     void Game::addStrategic(const Position &position, Strategy *s)
     {
-        int index = position.y + (position.x * __width);
         if (position.y >= __width || position.x >= __height) throw OutOfBoundsEx(__width, __height, position.x, position.y);
-        if (__grid[index]) throw PositionNonemptyEx(position.x, position.y);
+        if (__at(position.x, position.y)) throw PositionNonemptyEx(position.x, position.y);
 
-        __grid[index] = new Strategic(*this, position, STARTING_AGENT_ENERGY, s);
+        __setCell(__makeStrategic(position, s));
     }
 
     void Game::addStrategic(unsigned x, unsigned y, Strategy *s)
     {
-        int index = y + (x * __width);
         if (y >= __width || x >= __height) throw OutOfBoundsEx(__width, __height, x, y);
-        if (__grid[index]) throw PositionNonemptyEx(x, y);
+        if (__at(x, y)) throw PositionNonemptyEx(x, y);
 
-        __grid[index] = new Strategic(*this, Position(x, y), STARTING_AGENT_ENERGY, s);
+        __setCell(__makeStrategic(Position(x, y), s));
     }
 
     void Game::addFood(const Position &position)
     {
-        int index = position.y + (position.x * __width);
         if (position.y >= __width || position.x >= __height) throw OutOfBoundsEx(__width, __height, position.x, position.y);
-        if (__grid[index]) throw PositionNonemptyEx(position.x, position.y);
+        if (__at(position.x, position.y)) throw PositionNonemptyEx(position.x, position.y);
 
-        __grid[index] = new Food(*this, position, STARTING_RESOURCE_CAPACITY);
+        __setCell(__arena.make<Food>(*this, position, STARTING_RESOURCE_CAPACITY));
     }
 
     void Game::addFood(unsigned x, unsigned y)
     {
-        int index = y + (x * __width);
         if (y >= __width || x >= __height) throw OutOfBoundsEx(__width, __height, x, y);
-        if (__grid[index]) throw PositionNonemptyEx(x, y);
+        if (__at(x, y)) throw PositionNonemptyEx(x, y);
 
-        __grid[index] = new Food(*this, Position(x, y), STARTING_RESOURCE_CAPACITY);
+        __setCell(__arena.make<Food>(*this, Position(x, y), STARTING_RESOURCE_CAPACITY));
     }
 
     void Game::addAdvantage(const Position &position)
     {
-        int index = position.y + (position.x * __width);
         if (position.y >= __width || position.x >= __height) throw OutOfBoundsEx(__width, __height, position.x, position.y);
-        if (__grid[index]) throw PositionNonemptyEx(position.x, position.y);
+        if (__at(position.x, position.y)) throw PositionNonemptyEx(position.x, position.y);
 
-        __grid[index] = new Advantage(*this, position, STARTING_RESOURCE_CAPACITY);
+        __setCell(__arena.make<Advantage>(*this, position, STARTING_RESOURCE_CAPACITY));
     }
 
     void Game::addAdvantage(unsigned x, unsigned y)
     {
-        int index = y + (x * __width);
         if (y >= __width || x >= __height) throw OutOfBoundsEx(__width, __height, x, y);
-        if (__grid[index]) throw PositionNonemptyEx(x, y);
+        if (__at(x, y)) throw PositionNonemptyEx(x, y);
 
-        __grid[index] = new Advantage(*this, Position(x, y), STARTING_RESOURCE_CAPACITY);
+        __setCell(__arena.make<Advantage>(*this, Position(x, y), STARTING_RESOURCE_CAPACITY));
     }
 
     const Surroundings Game::getSurroundings(const Position &pos) const
     {
         //std::cout << "Getting surroundings..." << std::endl;
         Surroundings sur;
+        if (__soa)
+        {
+            return __soa->getSurroundings(pos);
+        }
+
+        if (!__codes.empty() && pos.x < __height && pos.y < __width)
+        {
+            return decodeNeighborhood(__codes[__codeIndex(pos.x, pos.y)]);
+        }
+
         for (int i = 0; i < 9; ++i)
         {
             sur.array[i] = EMPTY;
@@ -301,10 +843,9 @@ namespace Gaming
                     && pos.y + col >= 0 && pos.y + col < __width)
                 {
                     // In bounds
-                    unsigned int index = pos.y + col + ((pos.x + row) * __width);
                     //Piece *piece = __grid[pos.y + y + ((pos.x + x) * __width)];
-                    if (__grid[index])
-                        sur.array[col + 1 + ((row + 1) * 3)] = __grid[index]->getType();
+                    if (const Piece *piece = __at(pos.x + row, pos.y + col))
+                        sur.array[col + 1 + ((row + 1) * 3)] = piece->getType();
                 }
                 else
                 {
@@ -345,114 +886,517 @@ namespace Gaming
 
     bool Game::isLegal(const ActionType &ac, const Position &pos) const
     {
-        int x, y;
-        x = pos.x;
-        y = pos.y;
-        switch (ac)
+        unsigned x = pos.x + ACTION_DX[ac], y = pos.y + ACTION_DY[ac];    // note: wraps around below zero
+        return x < __height && y < __width;
+    }
+
+    const Position Game::move(const Position &pos, const ActionType &ac) const  // note: assumes legal, use with isLegal()
+    {
+        Position to(pos.x + ACTION_DX[ac], pos.y + ACTION_DY[ac]);
+        return (to.x < __height && to.y < __width) ? to : pos;
+    }
+
+    void Game::round()     // play a single round
+    {
+        std::vector<Event> *events = __sink ? &__events : nullptr;
+
+        ++__ticks;  // note: the resources spoil as the round starts (see Resource::__rawCapacity)
+        if (__fastForward && __skipToEnd(events))
+        {
+            // note: the rest of the game, bar the round counted below
+        }
+        else if (__soa)
+        {
+            __soa->round(__grid, __rng, __removed, events, __round);
+            __soaStale = true;
+            for (auto it = __removed.begin(); it != __removed.end(); ++it) __destroy(*it);
+            __removed.clear();
+        }
+        else if (__sparse)
+        {
+            __roundObjects(events);
+        }
+        else if (__update == SYNCHRONOUS)
+        {
+            __roundSynchronous(events);
+        }
+        else if (__pool)
+        {
+            __roundStripes(events);
+        }
+        else
         {
-            case E: y++; break;
-            case NE: y++; x--; break;
-            case N: x--; break;
-            case NW: y--; x--; break;
-            case W: y--; break;
-            case SW: y--; x++; break;
-            case S: x++; break;
-            case SE: x++; y++; break;
-            default: break;
+            __roundObjects(events);
         }
-        Position p((unsigned )x, (unsigned)y);
-        if (p.x < __height && p.y < __width)
-            return true;
-        return false;
+
+        if (events)
+        {
+            for (auto it = __events.begin(); it != __events.end(); ++it) __sink->record(*it);
+            __events.clear();
+        }
+
+        // Check game over
+        if (getNumResources() <= 0)
+        {
+            __status = Status::OVER;
+        }
+        __round++;
     }
 
-    const Position Game::move(const Position &pos, const ActionType &ac) const  // note: assumes legal, use with isLegal()
+    double Game::__valueOf(const Piece *piece)
     {
-        if (isLegal(ac, pos))
+        double value = piece->isMobile() ?
+                       static_cast<const Agent *>(piece)->getEnergy() :
+                       static_cast<const Resource *>(piece)->__rawCapacity();
+        return std::max(value, 0.0);
+    }
+
+    // Ages a piece and decides its move. The built-in pieces come through visitPiece as their own
+    // classes, so these calls are direct; resources don't look at their surroundings at all.
+    struct Game::__AgeAndDecide {
+        const Game &game;
+        Random &rng;
+
+        ActionType operator()(Resource &) const     // note: Food and Advantage spoil by themselves, see __ticks
         {
-            int x, y;
-            x = pos.x;
-            y = pos.y;
-            switch (ac)
+            return STAY;
+        }
+
+        ActionType operator()(Simple &piece) const
+        {
+            piece.age();
+            NeighborhoodCode code = neighborhood(piece);
+            if (asleep(piece, code)) return STAY;
+            return settle(piece, code, Simple::chooseAction(surroundings(piece)));
+        }
+
+        ActionType operator()(Strategic &piece) const
+        {
+            piece.age();
+            const Strategy *strategy = piece.getStrategy();
+            if (strategy == &__defaultStrategy) // note: the usual case, called without a virtual lookup
             {
-                case E: y++; break;
-                case NE: y++; x--; break;
-                case N: x--; break;
-                case NW: y--; x--; break;
-                case W: y--; break;
-                case SW: y--; x++; break;
-                case S: x++; break;
-                case SE: x++; y++; break;
-                default: break;
+                NeighborhoodCode code = neighborhood(piece);
+                if (asleep(piece, code)) return STAY;
+                return settle(piece, code, __defaultStrategy.DefaultAgentStrategy::operator()(surroundings(piece)));
             }
-            Position p((unsigned )x, (unsigned)y);
-            return p;
+            NeighborhoodCode code = strategy->isTypeDriven() ? neighborhood(piece) : NO_NEIGHBORHOOD;
+            if (asleep(piece, code)) return STAY;
+            return settle(piece, code, (*strategy)(surroundings(piece)));
         }
-        return pos;
-    }
 
-    void Game::round()     // play a single round
+        ActionType operator()(Piece &piece) const   // note: any other piece, through its virtual functions
+        {
+            piece.age();
+            return piece.takeTurn(surroundings(piece));
+        }
+
+        Surroundings surroundings(const Piece &piece) const
+        {
+            Surroundings surr = game.getSurroundings(piece.getPosition());
+            surr.rng = &rng;
+            return surr;
+        }
+
+        // note: NO_NEIGHBORHOOD unless the object grid keeps the codes
+        NeighborhoodCode neighborhood(const Piece &piece) const
+        {
+            if (game.__codes.empty()) return NO_NEIGHBORHOOD;
+            Position pos = piece.getPosition();
+            return game.__codes[game.__codeIndex(pos.x, pos.y)];
+        }
+
+        // an agent which had no option sleeps until any of the cells around it changes type
+        // note: the same types around a type-driven agent always leave it no option, and drew nothing from rng
+        static bool asleep(const Agent &agent, NeighborhoodCode code)
+        {
+            return code != NO_NEIGHBORHOOD && code == agent.__quiet;
+        }
+
+        static ActionType settle(Agent &agent, NeighborhoodCode code, ActionType ac)
+        {
+            agent.__quiet = (ac == STAY) ? code : NO_NEIGHBORHOOD;
+            return ac;
+        }
+    };
+
+    void Game::__takeTurn(Piece *piece, Random &rng, std::vector<Event> *events, std::vector<Piece *> &consumed)
     {
-        std::set<Piece*> pieces;
-        for (auto it = __grid.begin(); it != __grid.end(); ++it)
+        piece->setTurned(true);
+        ActionType ac = visitPiece(*piece, __AgeAndDecide{ *this, rng });
+        Position pos0 = piece->getPosition();
+        Position pos1 = move(pos0, ac);
+        if (pos0.x != pos1.x || pos0.y != pos1.y)
         {
-            if (*it)
+            Piece *p = __at(pos1.x, pos1.y);
+            if (p)
+            {
+                double value0 = events ? __valueOf(piece) : 0, other0 = events ? __valueOf(p) : 0;
+                (*piece) * (*p);
+                if (!p->isMobile() && !p->isViable()) consumed.push_back(p);
+                if (events)
+                {
+                    Event::Kind kind = p->isMobile() ? Event::FIGHT : Event::CONSUME;
+                    events->push_back(Event{ __round, kind, piece->getId(), p->getId(), pos0, pos1,
+                                             __valueOf(piece) - value0, __valueOf(p) - other0 });
+                }
+                if (piece->getPosition().x != pos0.x || piece->getPosition().y != pos0.y)
+                {
+                    // piece moved
+                    __put(pos1.x, pos1.y, piece);
+                    __put(pos0.x, pos0.y, p);
+                    if (events) events->push_back(Event{ __round, Event::MOVE, piece->getId(), 0, pos0, pos1, 0, 0 });
+                }
+            } else
             {
-                pieces.insert(pieces.end(), *it);
-                (*it)->setTurned(false);
+                // empty move
+                piece->setPosition(pos1);
+                __put(pos1.x, pos1.y, piece);
+                __put(pos0.x, pos0.y, nullptr);
+                if (events) events->push_back(Event{ __round, Event::MOVE, piece->getId(), 0, pos0, pos1, 0, 0 });
             }
         }
+    }
+
+    void Game::__roundObjects(std::vector<Event> *events)
+    {
+        // note: every agent on the board at the start of the round, nobody is added during one;
+        // the resources take no turns, they spoil by themselves
+        __occupied.clear();
+        __listPieces(__occupied, false);
+        __scheduler.schedule(__occupied, __rng);
+        for (auto it = __scheduler.begin(); it != __scheduler.end(); ++it)
+        {
+            (*it)->setTurned(false);
+        }
 
         // Take turns
-        for (auto it = pieces.begin(); it != pieces.end(); ++it)
+        for (auto it = __scheduler.begin(); it != __scheduler.end(); ++it)
         {
             if (!(*it)->getTurned())
             {
-                (*it)->setTurned(true);
-                (*it)->age();
-                ActionType ac = (*it)->takeTurn(getSurroundings((*it)->getPosition()));
-                Position pos0 = (*it)->getPosition();
-                Position pos1 = move(pos0, ac);
-                if (pos0.x != pos1.x || pos0.y != pos1.y)
-                {
-                    Piece *p = __grid[pos1.y + (pos1.x * __width)];
-                    if (p)
+                __takeTurn(*it, __rng, events, __removed);
+            }
+        }
+
+        // Update positions and delete
+        // Delete invalid first
+        __removeDead(events);
+    }
+
+    // The board is cut into stripes of STRIPE_ROWS rows. A piece only ever reads
+    // and writes the cells of the rows next to its own, and the neighborhood codes
+    // of one more row either way (see __recode), so the stripes of one parity can't
+    // reach each other and are played concurrently: first the even stripes,
+    // then the odd ones. Each stripe plays the pieces it had at the start of the
+    // round in grid order and draws from its own source split off the game seed,
+    // which keeps the outcome independent of the number of threads and of their timing.
+    void Game::__roundStripes(std::vector<Event> *events)
+    {
+        const unsigned numStripes = (__height + STRIPE_ROWS - 1) / STRIPE_ROWS;
+        std::vector<std::vector<Piece *> > stripes(numStripes);
+        std::vector<std::vector<Event> > stripeEvents(events ? numStripes : 0);
+        std::vector<std::vector<Piece *> > stripeConsumed(numStripes);
+
+        __occupied.clear();
+        __listPieces(__occupied, false);
+        for (auto it = __occupied.begin(); it != __occupied.end(); ++it)
+        {
+            (*it)->setTurned(false);
+            stripes[(*it)->getPosition().x / STRIPE_ROWS].push_back(*it);
+        }
+
+        for (unsigned parity = 0; parity < 2; ++parity)
+        {
+            __pool->parallelFor((numStripes + 1 - parity) / 2, [&](unsigned task) {
+                unsigned stripe = 2 * task + parity;
+                Random rng = __rng.split(__round, stripe);
+                std::vector<Event> *own = events ? &stripeEvents[stripe] : nullptr;
+                // note: a piece pushed out of the stripe (e.g. an agent beaten in a fight) misses its turn,
+                // a piece acting outside it could reach the stripes played alongside
+                for (auto it = stripes[stripe].begin(); it != stripes[stripe].end(); ++it)
+                    if (!(*it)->getTurned() && (*it)->getPosition().x / STRIPE_ROWS == stripe)
+                        __takeTurn(*it, rng, own, stripeConsumed[stripe]);
+            });
+        }
+        for (unsigned stripe = 0; stripe < numStripes; ++stripe)
+            __removed.insert(__removed.end(), stripeConsumed[stripe].begin(), stripeConsumed[stripe].end());
+
+        // Events in the order of play: the even stripes, then the odd ones
+        for (unsigned parity = 0; events && parity < 2; ++parity)
+            for (unsigned stripe = parity; stripe < numStripes; stripe += 2)
+                events->insert(events->end(), stripeEvents[stripe].begin(), stripeEvents[stripe].end());
+
+        __removeDead(events);
+    }
+
+    // Take the pieces which are no longer viable off the board, in grid order: the agents of __occupied,
+    // the resources consumed in the round (already in __removed) and those spoiling as it ends
+    void Game::__removeDead(std::vector<Event> *events)
+    {
+        for (auto it = __occupied.begin(); it != __occupied.end(); ++it)
+        {
+            if (!(*it)->isViable()) __removed.push_back(*it);
+        }
+        __spoiling.collect(__ticks, __removed);
+        std::sort(__removed.begin(), __removed.end(), __inGridOrder);
+        __removed.erase(std::unique(__removed.begin(), __removed.end()), __removed.end()); // note: consumed as they spoiled
+        for (auto it = __removed.begin(); it != __removed.end(); ++it)
+        {
+            Position pos = (*it)->getPosition();
+            if (events)
+                events->push_back(Event{ __round, Event::REMOVE, (*it)->getId(), 0, pos, pos,
+                                         -__valueOf(*it), 0 });
+            __put(pos.x, pos.y, nullptr);
+            __destroy(*it);
+        }
+        __removed.clear();
+    }
+
+    // A synchronous round reads one board and builds the next:
+    //  1. every agent ages and decides on the board as it was at the start of the round
+    //  2. an agent heading for another agent attacks it and stays where it is (in grid order)
+    //  3. of the agents heading for the same free or resource cell the strongest gets there,
+    //     the oldest on a tie; the others stay where they are
+    //  4. the winners take their cells (consuming any resource there), the rest of the pieces stay,
+    //     and the pieces which didn't make it are left off the next board
+    // Steps 1, 3 and 4 only write cells of their own row, so the rows are played concurrently.
+    // Every row draws from its own source, so the outcome doesn't depend on the number of threads.
+    void Game::__roundSynchronous(std::vector<Event> *events)
+    {
+        const unsigned numCells = __width * __height;   // note: cells are numbered row-major whatever the layout
+        const unsigned NONE = numCells;
+        __targets.assign(numCells, NONE);
+        __winners.assign(numCells, NONE);
+        __next.assign(__grid.size(), nullptr);
+        std::vector<std::vector<Event> > rowEvents(events ? __height : 0);
+
+        auto forRows = [this](const std::function<void(unsigned)> &task) {
+            if (__pool) __pool->parallelFor(__height, task);
+            else for (unsigned x = 0; x < __height; ++x) task(x);
+        };
+        auto at = [this](unsigned c) { return __grid[__index(c / __width, c % __width)]; };
+        auto isAgent = [](const Piece *piece) { return piece && piece->isMobile(); };
+
+        // 1. age and decide (note: the resources have spoiled already, as the round started)
+        forRows([&](unsigned x) {
+            Random rng = __rng.split(__round, x);
+            for (unsigned i = x * __width; i < (x + 1) * __width; ++i)
+            {
+                Piece *piece = at(i);
+                if (!isAgent(piece)) continue;
+                ActionType ac = visitPiece(*piece, __AgeAndDecide{ *this, rng });
+
+                Position to = move(piece->getPosition(), ac);
+                __targets[i] = to.y + to.x * __width;
+            }
+        });
+
+        // 2. fights
+        for (unsigned i = 0; i < numCells; ++i)
+        {
+            unsigned t = __targets[i];
+            if (t == NONE || t == i || !isAgent(at(t))) continue;
+
+            __targets[i] = i;
+            Piece *attacker = at(i), *defender = at(t);
+            if (!attacker->isViable() || !defender->isViable()) continue;
+
+            double value0 = __valueOf(attacker), other0 = __valueOf(defender);
+            attacker->interact(static_cast<Agent *>(defender));
+            if (events)
+                events->push_back(Event{ __round, Event::FIGHT, attacker->getId(), defender->getId(),
+                                         attacker->getPosition(), defender->getPosition(),
+                                         __valueOf(attacker) - value0, __valueOf(defender) - other0 });
+        }
+
+        // 3. one agent per cell
+        forRows([&](unsigned x) {
+            for (unsigned y = 0; y < __width; ++y)
+            {
+                unsigned t = y + x * __width, best = NONE;
+                for (unsigned nx = x ? x - 1 : 0; nx <= x + 1 && nx < __height; ++nx)
+                    for (unsigned ny = y ? y - 1 : 0; ny <= y + 1 && ny < __width; ++ny)
                     {
-                        (*(*it)) * (*p);
-                        if ((*it)->getPosition().x != pos0.x || (*it)->getPosition().y != pos0.y)
-                        {
-                            // piece moved
-                            __grid[pos1.y + (pos1.x * __width)] = (*it);
-                            __grid[pos0.y + (pos0.x * __width)] = p;
-                        }
-                    } else
+                        unsigned n = ny + nx * __width;
+                        if (n == t || __targets[n] != t || !at(n)->isViable()) continue;
+                        if (best == NONE) { best = n; continue; }
+
+                        double e = static_cast<const Agent *>(at(n))->getEnergy();
+                        double eBest = static_cast<const Agent *>(at(best))->getEnergy();
+                        if (e > eBest || (e == eBest && at(n)->getId() < at(best)->getId())) best = n;
+                    }
+                __winners[t] = best;
+            }
+        });
+
+        // 4. the next board
+        forRows([&](unsigned x) {
+            for (unsigned y = 0; y < __width; ++y)
+            {
+                unsigned c = y + x * __width, w = __winners[c];
+                Piece *&next = __next[__index(x, y)];
+                if (w != NONE)
+                {
+                    Piece *mover = at(w), *resource = at(c);
+                    Position from = mover->getPosition(), to(x, y);
+                    if (resource)
                     {
-                        // empty move
-                        (*it)->setPosition(pos1);
-                        __grid[pos1.y + (pos1.x * __width)] = (*it);
-                        __grid[pos0.y + (pos0.x * __width)] = nullptr;
+                        double value0 = __valueOf(mover), other0 = __valueOf(resource);
+                        mover->interact(static_cast<Resource *>(resource));
+                        if (events)
+                            rowEvents[x].push_back(Event{ __round, Event::CONSUME, mover->getId(), resource->getId(),
+                                                          from, to, __valueOf(mover) - value0, __valueOf(resource) - other0 });
                     }
+                    mover->setPosition(to);
+                    next = mover;
+                    if (events) rowEvents[x].push_back(Event{ __round, Event::MOVE, mover->getId(), 0, from, to, 0, 0 });
+                }
+                else if (at(c) && !(__targets[c] != NONE && __targets[c] != c && __winners[__targets[c]] == c))
+                {
+                    next = at(c);
                 }
             }
+        });
+        for (unsigned x = 0; events && x < __height; ++x)
+            events->insert(events->end(), rowEvents[x].begin(), rowEvents[x].end());
+
+        // Delete the consumed resources and the pieces which didn't make it, then swap the boards
+        for (unsigned c = 0; c < numCells; ++c)
+        {
+            Piece *&next = __next[__index(c / __width, c % __width)];
+            Piece *gone[2] = { (__winners[c] != NONE) ? at(c) : nullptr, nullptr };
+            if (next && !next->isViable())
+            {
+                gone[1] = next;
+                next = nullptr;
+            }
+            for (unsigned k = 0; k < 2; ++k)
+            {
+                if (!gone[k]) continue;
+                if (events)
+                {
+                    Position pos(c / __width, c % __width);
+                    events->push_back(Event{ __round, Event::REMOVE, gone[k]->getId(), 0, pos, pos,
+                                             -__valueOf(gone[k]), 0 });
+                }
+                __destroy(gone[k]);
+            }
         }
+        __grid.swap(__next);
+        __encodeNeighborhoods();
+    }
 
-        // Update positions and delete
-        // Delete invalid first
-        for (unsigned int i = 0; i < __grid.size(); ++i)
+    // The rounds a piece with value, losing rate a round, has left: it leaves the board at the end
+    // of the last one. Capped at limit, so the round counter can't overflow.
+    unsigned Game::__roundsLeft(double value, double rate, unsigned limit)
+    {
+        if (value <= 0) return 1;
+        if (value >= limit * rate) return limit;
+        unsigned n = std::max((unsigned) std::ceil(value / rate), 1u);
+        while (n > 1 && value - (n - 1) * rate <= 0) --n;   // note: the value after n rounds, in closed form
+        while (n < limit && value - n * rate > 0) ++n;
+        return n;
+    }
+
+    // Pieces move a cell a round at most, so an agent d cells away from a resource can't get to it
+    // in fewer than d rounds. If none of the agents can get to any resource while both are still on
+    // the board, the resources just spoil one after the other and the game is over when the last one
+    // does: the rounds up to then are skipped, and the agents age through them in closed form.
+    // Each agent only looks as far as it can still go, ring by ring from its own cell, so the check
+    // usually stops at the first agent next to a resource; an agent whose window holds more cells
+    // than there are resources goes through the resources instead.
+    // note: called as a round starts, once the resources have spoiled for it
+    bool Game::__skipToEnd(std::vector<Event> *events)
+    {
+        if (getNumResources() == 0) return false;
+
+        __syncPieces();
+
+        // whether an agent d cells away gets to piece before it is gone (d >= 1)
+        auto reachable = [this](const Piece *piece, unsigned d) {
+            return piece && !piece->isMobile() && static_cast<const Resource *>(piece)->__expiry - __ticks >= d - 1;
+        };
+
+        std::vector<Piece *> resources;     // note: listed only if some agent needs them
+        const unsigned reach = std::max(__width, __height);
+        for (auto it = __live.begin(); it != __live.end(); ++it)
         {
-            if (__grid[i] && !(__grid[i]->isViable()))
+            Position pa = (*it)->getPosition();
+            unsigned radius = __roundsLeft(static_cast<Agent *>(*it)->getEnergy(), Agent::AGENT_FATIGUE_RATE, reach);
+            if ((std::uint64_t) (2 * radius + 1) * (2 * radius + 1) > getNumResources())
             {
-                delete __grid[i];
-                __grid[i] = nullptr;
+                if (resources.empty()) __spoiling.collectAll(resources);
+                for (auto r = resources.begin(); r != resources.end(); ++r)
+                {
+                    Position pr = (*r)->getPosition();
+                    unsigned distance = std::max(std::max(pa.x, pr.x) - std::min(pa.x, pr.x),
+                                                 std::max(pa.y, pr.y) - std::min(pa.y, pr.y));
+                    if (distance <= radius && reachable(*r, distance)) return false;
+                }
+                continue;
+            }
+            for (unsigned d = 1; d <= radius; ++d)
+            {
+                unsigned x0 = pa.x >= d ? pa.x - d : 0, x1 = std::min(pa.x + d, __height - 1);
+                unsigned y0 = pa.y >= d ? pa.y - d : 0, y1 = std::min(pa.y + d, __width - 1);
+                for (unsigned x = x0; x <= x1; ++x)
+                {
+                    if (x + d == pa.x || x == pa.x + d)
+                    {
+                        for (unsigned y = y0; y <= y1; ++y)
+                            if (reachable(__at(x, y), d)) return false;
+                    }
+                    else
+                    {
+                        if (pa.y >= d && reachable(__at(x, pa.y - d), d)) return false;
+                        if (pa.y + d < __width && reachable(__at(x, pa.y + d), d)) return false;
+                    }
+                }
             }
         }
 
-        // Check game over
-        if (getNumResources() <= 0)
+        // the rounds each resource has left, this one included, up to the end of the game
+        if (resources.empty()) __spoiling.collectAll(resources);
+        const unsigned limit = std::numeric_limits<unsigned>::max() - __round;
+        unsigned numRounds = 0;
+        for (auto r = resources.begin(); r != resources.end(); ++r)
         {
-            __status = Status::OVER;
+            unsigned expiry = static_cast<Resource *>(*r)->__expiry;
+            if (expiry - __ticks >= limit) return false;
+            numRounds = std::max(numRounds, expiry - __ticks + 1);
         }
-        __round++;
+
+        // age the agents, and list the pieces gone by the end by the round they leave in, each round in grid order
+        std::vector<std::pair<unsigned, Piece *> > gone;
+        for (auto it = __live.begin(); it != __live.end(); ++it)
+        {
+            Agent *agent = static_cast<Agent *>(*it);
+            unsigned left = __roundsLeft(agent->getEnergy(), Agent::AGENT_FATIGUE_RATE, numRounds + 1);
+            agent->addEnergy(-(std::min(left, numRounds) * Agent::AGENT_FATIGUE_RATE));
+            if (left <= numRounds) gone.push_back(std::make_pair(__round + left - 1, *it));
+        }
+        for (auto r = resources.begin(); r != resources.end(); ++r)
+            gone.push_back(std::make_pair(__round + static_cast<Resource *>(*r)->__expiry - __ticks, *r));
+        std::sort(gone.begin(), gone.end(),
+                  [](const std::pair<unsigned, Piece *> &a, const std::pair<unsigned, Piece *> &b) {
+                      return a.first < b.first || (a.first == b.first && __inGridOrder(a.second, b.second));
+                  });
+
+        __round += numRounds - 1;   // note: round() counts the last one
+        __ticks += numRounds - 1;
+        for (auto it = gone.begin(); it != gone.end(); ++it)
+        {
+            Position pos = it->second->getPosition();
+            if (events)
+                events->push_back(Event{ it->first, Event::REMOVE, it->second->getId(), 0, pos, pos,
+                                         -__valueOf(it->second), 0 });
+            __put(pos.x, pos.y, nullptr);
+            __destroy(it->second);
+        }
+        if (__soa) __soa->load(__grid);
+
+        return true;
     }
 
     void Game::play(bool verbose)   // play game until over
@@ -468,44 +1412,66 @@ namespace Gaming
         if (!verbose) std::cout << *this;
     }
 
-    std::ostream &operator<<(std::ostream &os, const Game &game)
+    void Game::__render(std::string &frame) const
     {
-        os << "Round " << game.__round << std::endl;
-        int column = 0;
-        for (auto it = game.__grid.begin(); it != game.__grid.end(); ++it)
+        static const char symbols[INACCESSIBLE] = {
+                Simple::SIMPLE_ID, Strategic::STRATEGIC_ID, Food::FOOD_ID, Advantage::ADVANTAGE_ID };
+        static const char *statuses[] = { "Not Started...\n", "Playing...\n", "Over!\n" };
+
+        // decimal digits of n, written backwards into the end of a scratch buffer
+        char digits[10];
+        auto append = [&frame, &digits](unsigned int n) {
+            char *p = digits + sizeof(digits);
+            do { *--p = (char) ('0' + n % 10); n /= 10; } while (n);
+            frame.append(p, digits + sizeof(digits) - p);
+        };
+
+        frame.clear();
+        frame.reserve((std::size_t) __width * __height * 8 + __height + 32); // note: "[S1234]", a newline per row, round and status
+
+        frame += "Round ";
+        append(__round);
+        frame += '\n';
+        for (unsigned x = 0; x < __height; ++x)
         {
-            if (*it == nullptr)
-            {
-                os << "[" << std::setw(6) << "]";
-            } else
-            {
-                //os ;
-                std::stringstream ss;
-                ss << "[" << **it;
-                std::string str;
-                std::getline(ss, str);
-                //os << str << std::setw(3) << "]";
-                os << str << "]";
-                //os << std::setw(4) << "[" << **it;
-                //os << "]";
-                //os ;
-            }
-            if (++column == game.__width)
+            for (unsigned y = 0; y < __width; ++y)
             {
-                column = 0;
-                os << std::endl;
+                const Piece *piece = __at(x, y);
+                if (piece == nullptr)
+                {
+                    frame.append("[     ]", 7);
+                }
+                else
+                {
+                    frame += '[';
+                    if (piece->getTag() < INACCESSIBLE)
+                    {
+                        frame += symbols[piece->getTag()];
+                        append(piece->getId());
+                    }
+                    else
+                    {
+                        // note: a piece of no built-in class prints itself, the first line only
+                        std::stringstream ss;
+                        ss << *piece;
+                        std::string line;
+                        std::getline(ss, line);
+                        frame += line;
+                    }
+                    frame += ']';
+                }
             }
+            frame += '\n';
         }
-        os << "Status: ";
-        switch (game.getStatus())
-        {
-            case Game::Status::NOT_STARTED:
-                std::cout << "Not Started..." << std::endl; break;
-            case Game::Status::PLAYING:
-                std::cout << "Playing..." << std::endl; break;
-            default:
-                std::cout << "Over!" << std::endl; break;
-        }
-        return os;
+        frame += "Status: ";
+        frame += statuses[__status];
+    }
+
+    std::ostream &operator<<(std::ostream &os, const Game &game)
+    {
+        thread_local std::string frame; // note: reused from print to print, one per thread
+        game.__render(frame);
+        os.write(frame.data(), frame.size());
+        return os.flush();
     }
-}
\ No newline at end of file
+}
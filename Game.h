@@ -8,35 +8,134 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <string>
 
 #include "Gaming.h"
 #include "DefaultAgentStrategy.h"
+#include "TurnScheduler.h"
+#include "ThreadPool.h"
+#include "PieceArena.h"
+#include "CellIndex.h"
+#include "TimingWheel.h"
+#include "NeighborhoodCodes.h"
+#include "EventLog.h"
 
 namespace Gaming {
 
     class Piece;
     class Agent;
+    class Resource;
     class Strategy;
     class DefaultAgentStrategy;
+    class SoAGrid;
+    class SparseGrid;
+
+    // what happens when a piece moves onto another, returns the moving piece
+    typedef Piece &(*Interaction)(Piece &piece, Piece &other);
+
+    // indexed by the PieceType of the moving piece, then of the other
+    typedef std::array<std::array<Interaction, INACCESSIBLE>, INACCESSIBLE> InteractionTable;
 
     class Game {
+        friend class Resource;  // note: resources spoil by the ticks of their game
+
     public:
         enum Status { NOT_STARTED, PLAYING, OVER };
 
+        // OBJECT_GRID plays on the Piece objects directly, SOA_GRID on contiguous per-cell planes,
+        // SPARSE_GRID on the Piece objects of the occupied tiles only (for huge, mostly empty boards)
+        enum Backend { OBJECT_GRID, SOA_GRID, SPARSE_GRID };
+
+        // SEQUENTIAL: the pieces take turns one after the other, each seeing the moves made before its own
+        // SYNCHRONOUS: all the pieces decide on the board as it was at the start of the round, then the moves
+        // are resolved together (see __roundSynchronous)
+        enum Update { SEQUENTIAL, SYNCHRONOUS };
+
     private:
         static const unsigned int NUM_INIT_AGENT_FACTOR;
         static const unsigned int NUM_INIT_RESOURCE_FACTOR;
 
         static PositionRandomizer __posRandomizer;
+        static DefaultAgentStrategy __defaultStrategy; // note: stateless, shared by all default Strategic agents
 
         void populate(); // populate the grid (used in automatic random initialization of a Game)
 
         unsigned __numInitAgents, __numInitResources;
 
         unsigned __width, __height;
-        std::vector<Piece *> __grid; // if a position is empty, nullptr
+        PieceArena __arena;         // the pieces on the grid live here
+
+        std::vector<Piece *> __grid; // if a position is empty, nullptr; no cells at all with SPARSE_GRID
+        CellIndex __index;           // where the cells of __grid are (always row-major under SOA_GRID)
+        CellIndex::Layout __layout;  // the layout of the object grid
+        PieceCounts __numPieces;     // live counts, kept up to date on every add and removal
+        std::vector<Piece *> __live; // every mobile piece on the board, in no particular order (see Piece::__slot)
+        mutable TimingWheel __spoiling; // every immobile piece (resource) on the board, by the tick it spoils at
+                                        // note: mutable, as resources aged by hand move on it (see __respoil)
+        std::vector<NeighborhoodCode> __codes; // per cell, row-major: the types around it, kept up to date by __put
+                                               // note: empty unless the OBJECT_GRID backend is selected
+        // where the code of (x, y) is: the board sits in a ring of cells nobody reads, so that every
+        // cell has 8 neighbors to write to (see __recode)
+        unsigned __codeIndex(unsigned x, unsigned y) const { return (x + 1) * (__width + 2) + y + 1; }
+
+        Backend __backend;
+        SoAGrid *__soa;             // nullptr unless the SOA_GRID backend is selected
+        mutable bool __soaStale;    // Piece objects lag behind the SoAGrid planes
+        SparseGrid *__sparse;       // nullptr unless the SPARSE_GRID backend is selected
+        std::vector<Piece *> __occupied;    // the agents at the start of the round, in grid order
+
+        TurnScheduler __scheduler;  // note: the SOA_GRID backend always plays in grid order
+
+        mutable Random __rng;       // every random decision of the game is drawn from here
+
+        ThreadPool *__pool;         // nullptr while rounds are played sequentially
+
+        Update __update;
+        InteractionTable __interactions;    // see setInteraction
+        bool __customInteractions() const;
+        bool __fastForward;         // see setFastForward
+        std::vector<Piece *> __next;        // the board a synchronous round builds, swapped in at the end
+        std::vector<unsigned> __targets;    // per cell, the cell its piece heads for in a synchronous round
+        std::vector<unsigned> __winners;    // per cell, the cell of the agent which gets there
+
+        EventSink *__sink;          // not owned, nullptr unless events are recorded
+        // the events of the current round, passed on once it is over
+        // note: a whole round is buffered here before the sink sees any of it, so its memory grows with
+        // the events of one round (a few per piece) whatever the batch size of the sink
+        std::vector<Event> __events;
+        static double __valueOf(const Piece *piece);
+
+        struct __AgeAndDecide;      // the visitor of a turn (see __takeTurn)
+
+        Piece *__at(unsigned x, unsigned y) const;
+        void __put(unsigned x, unsigned y, Piece *piece);  // note: doesn't count or destroy pieces
+        void __recode(unsigned x, unsigned y, PieceType type);
+        void __encodeNeighborhoods();
+        void __setCell(Piece *piece);                       // note: at the position of the piece
+        unsigned __expiryOf(const Resource *resource) const;
+        void __respoil(Resource *resource) const;           // note: after Resource::age, if it is on the board
+        void __relayout(CellIndex::Layout layout);
+        // note: in row-major order whatever the layout
+        void __listPieces(std::vector<Piece *> &pieces, bool withImmobile = true) const;
+        static bool __inGridOrder(const Piece *a, const Piece *b);
+        void __destroy(Piece *piece);
+        void __destroyAll();
+        void __release();           // note: everything the game owns, also when a constructor throws
+        Piece *__makeStrategic(const Position &position, Strategy *s);
+        std::vector<Piece *> __removed;     // pieces taken off the grid in the current round
+        void __syncPieces() const;
+        void __roundObjects(std::vector<Event> *events);
+        void __roundStripes(std::vector<Event> *events);
+        void __removeDead(std::vector<Event> *events);
+        void __roundSynchronous(std::vector<Event> *events);
+        void __takeTurn(Piece *piece, Random &rng, std::vector<Event> *events, std::vector<Piece *> &consumed);
+        static unsigned __roundsLeft(double value, double rate, unsigned limit);
+        bool __skipToEnd(std::vector<Event> *events);
+
+        void __render(std::string &frame) const;    // note: the text of the board, ids formatted by hand
 
         unsigned int __round;
+        unsigned int __ticks;   // the rounds started so far, the resources spoil as each one starts
 
         Status __status;
 
@@ -44,15 +143,28 @@ namespace Gaming {
 
     public:
         static const unsigned MIN_WIDTH, MIN_HEIGHT;
+        static const unsigned STRIPE_ROWS;  // height of the board stripes played in parallel
+        static const unsigned SORT_LIVE_FACTOR; // list the pieces from __live when there are this many cells per piece
         static const double STARTING_AGENT_ENERGY;
         static const double STARTING_RESOURCE_CAPACITY;
 
         Game();
         Game(unsigned width, unsigned height, bool manual = true); // note: manual population by default
+        Game(unsigned width, unsigned height, bool manual, unsigned int seed); // note: reproducible play
+        Game(unsigned width, unsigned height, Backend backend, unsigned int seed); // note: manual population
+        explicit Game(const std::string &snapshot); // note: picks up where save() left off, throws SnapshotEx
+        // an independent copy which plays on exactly as the original would
+        // note: throws UnsupportedEx if a piece or a strategy can't be cloned, and leaks nothing
         Game(const Game &another);
         Game &operator=(const Game &other) = delete;
         ~Game();
 
+        // a copy which plays on with random decisions of its own: the same branch of
+        // the same state always plays out the same, different branches diverge
+        // note: returned by value and built by the copy constructor, so correctness doesn't
+        // hinge on copy elision; Game can't be assigned, so hold it as Game f = g.fork(n)
+        Game fork(unsigned int branch) const;
+
         // getters
         unsigned int getWidth() const { return __width; }
         unsigned int getHeight() const { return __height; }
@@ -63,19 +175,74 @@ namespace Gaming {
         unsigned int getNumResources() const;
         Status getStatus() const { return __status; }
         unsigned int getRound() const { return __round; }
+        unsigned int getSeed() const { return __rng.getSeed(); }
         const Piece *getPiece(unsigned int x, unsigned int y) const;
+        Backend getBackend() const { return __backend; }
+        TurnScheduler::Order getTurnOrder() const { return __scheduler.getOrder(); }
+        void setTurnOrder(TurnScheduler::Order order) { __scheduler.setOrder(order); }
+        unsigned getNumThreads() const { return __pool ? __pool->size() : 1; }
+
+        // play the rounds of the object grid on this many threads; 1 plays them sequentially
+        // note: parallel rounds are reproducible for a given seed, but differ from sequential ones
+        void setNumThreads(unsigned numThreads);
+
+        // switch the storage the rounds are played on; the pieces on the board are kept
+        // note: switching away from SPARSE_GRID allocates every cell of the board; throws UnsupportedEx
+        // for SOA_GRID with interactions of its own (see setInteraction)
+        void setBackend(Backend backend);
+
+        // arrange the cells of the object grid in memory, see CellIndex; the play is the same in every layout
+        // note: the SOA_GRID planes are always row-major, and the SPARSE_GRID tiles have no use for a layout
+        CellIndex::Layout getLayout() const { return __layout; }
+        void setLayout(CellIndex::Layout layout);
+
+        // note: synchronous and parallel rounds are played on the object grid, the other backends are always
+        // sequential; throws UnsupportedEx for SYNCHRONOUS with interactions of its own (see setInteraction)
+        Update getUpdate() const { return __update; }
+        void setUpdate(Update update);
+
+        // what happens in this game when a piece of type moves onto one of otherType (see Piece::operator*)
+        // note: only sequential rounds of the object and sparse grids go through the table, the SOA_GRID
+        // backend and SYNCHRONOUS rounds resolve moves by the default rules; setting an entry of another
+        // rule in those modes, or switching to them with one set, throws UnsupportedEx
+        // note: both types must be of actual pieces (SIMPLE to ADVANTAGE) and the interaction not nullptr,
+        // else UnsupportedEx
+        Interaction getInteraction(PieceType type, PieceType otherType) const;
+        void setInteraction(PieceType type, PieceType otherType, Interaction interaction);
+
+        // when no agent can reach a resource before it spoils, play the rest of the game in a single
+        // round(): the round counter jumps to the round the last resource spoils, and every agent loses
+        // its fatigue over the rounds skipped, all at once
+        // note: the agents keep their cells and don't fight in the rounds skipped; without agents on
+        // the board the game ends exactly as if the rounds had been played
+        bool getFastForward() const { return __fastForward; }
+        void setFastForward(bool fastForward) { __fastForward = fastForward; }
+
+        // pass every move, fight, consumption and removal to sink from the next round on; nullptr to stop
+        // note: the sink is not owned, and receives the events of a round when the round is over,
+        // all at once: nothing of a round reaches it while the round is being played
+        void setEventSink(EventSink *sink) { __sink = sink; }
+        EventSink *getEventSink() const { return __sink; }
+
+        // write the state of the game to a binary snapshot file (see Snapshot.h), throws SnapshotEx
+        // note: only default and aggressive strategies and the default interactions can be saved;
+        // the number of threads is not saved
+        void save(const std::string &path) const;
 
         // grid population methods
+        void populate(unsigned agentFactor, unsigned resourceFactor); // note: one agent per agentFactor cells, etc.
         void addSimple(const Position &position);
         void addSimple(const Position &position, double energy); // used for testing only
         void addSimple(unsigned x, unsigned y);
         void addSimple(unsigned x, unsigned y, double energy);
-        void addStrategic(const Position &position, Strategy *s = new DefaultAgentStrategy());
-        void addStrategic(unsigned x, unsigned y, Strategy *s = new DefaultAgentStrategy());
+        void addStrategic(const Position &position, Strategy *s = nullptr); // note: nullptr for the default strategy
+        void addStrategic(unsigned x, unsigned y, Strategy *s = nullptr);
         void addFood(const Position &position);
         void addFood(unsigned x, unsigned y);
         void addAdvantage(const Position &position);
         void addAdvantage(unsigned x, unsigned y);
+        // note: with no rng, so deciding on it draws from Random::fallback() and leaves the game's
+        // own stream alone; only turns of the game draw from it
         const Surroundings getSurroundings(const Position &pos) const;
 
         // gameplay methods
@@ -83,10 +250,13 @@ namespace Gaming {
         static const Position randomPosition(const std::vector<int> &positions) { // note: from Surroundings as an array
             return __posRandomizer(positions);
         }
+        static const Position randomPosition(const std::vector<int> &positions, Random &rng) { // note: e.g. Surroundings::rng
+            return __posRandomizer(positions, rng);
+        }
 
         bool isLegal(const ActionType &ac, const Position &pos) const;
         const Position move(const Position &pos, const ActionType &ac) const; // note: assumes legal, use with isLegal()
-        void round();   // play a single round
+        void round();   // play a single round, or the rest of the game (see setFastForward)
         void play(bool verbose = false);    // play game until over
 
 //        const Agent &winner(); // what if no winner or multiple winners?
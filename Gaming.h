@@ -6,7 +6,10 @@
 #define PA5GAME_GAMING_H
 
 #include <array>
+#include <vector>
 #include <random>
+#include <sstream>
+#include <string>
 #include "Exceptions.h"
 
 namespace Gaming {
@@ -24,6 +27,52 @@ namespace Gaming {
     // what a position on the game grid can be filled with
     enum PieceType { SIMPLE=0, STRATEGIC, FOOD, ADVANTAGE, INACCESSIBLE, SELF, EMPTY };
 
+    // number of pieces by type, indexed by the PieceType of an actual piece (SIMPLE to ADVANTAGE)
+    typedef std::array<unsigned int, INACCESSIBLE> PieceCounts;
+
+    // seedable source of pseudo-random numbers for the decisions made in a Game
+    class Random {
+        std::default_random_engine __gen;
+        unsigned int __seed;
+
+    public:
+        typedef std::default_random_engine::result_type result_type;
+
+        explicit Random(unsigned int seed) : __gen(seed), __seed(seed) {}
+
+        unsigned int getSeed() const { return __seed; }
+        void seed(unsigned int seed) { __gen.seed(seed); __seed = seed; }
+
+        static constexpr result_type min() { return std::default_random_engine::min(); }
+        static constexpr result_type max() { return std::default_random_engine::max(); }
+        result_type operator()() { return __gen(); }
+
+        // the state of the engine as text, to pick up a sequence where it was left off
+        std::string getState() const {
+            std::ostringstream os;
+            os << __gen;
+            return os.str();
+        }
+        bool setState(const std::string &state) { // note: false if the state is not one of getState()
+            std::istringstream is(state);
+            return (bool) (is >> __gen);
+        }
+
+        // an independent source for a stream (e.g. a round and a board stripe) of the same seed
+        Random split(unsigned int stream, unsigned int substream) const {
+            unsigned long long z = ((unsigned long long) __seed << 32 | stream) + 0x9e3779b97f4a7c15ULL * (substream + 1ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return Random((unsigned int) (z ^ (z >> 31)));
+        }
+
+        // per-thread source for decisions made without a Game (e.g. on hand-built Surroundings)
+        static Random &fallback() {
+            thread_local Random rng(std::random_device{}());
+            return rng;
+        }
+    };
+
     // a "map" of the 8 squares adjacent to a piece
     struct Surroundings {
         // encoded as an array/vector top-left row-wise bottom-right
@@ -32,14 +81,55 @@ namespace Gaming {
         // [6][7][8]
         // the piece is always at 1x1 (SELF)
         std::array<PieceType, 9> array;
+
+        // where the piece draws its random choices from, Random::fallback() if nullptr
+        Random *rng = nullptr;
+    };
+
+    // 9-bit occupancy masks of a Surroundings, one per PieceType: bit i is set when cell i holds that type
+    struct NeighborhoodMasks {
+        std::array<unsigned int, EMPTY + 1> of;
+
+        explicit NeighborhoodMasks(const Surroundings &s) {
+            of.fill(0);
+            for (unsigned int i = 0; i < 9; ++i) of[s.array[i]] |= 1u << i;
+        }
+
+        unsigned int operator[](PieceType type) const { return of[type]; }
     };
 
+    // the move onto each cell of a Surroundings
+    static const ActionType CELL_ACTIONS[9] = { NW, N, NE, W, STAY, E, SW, S, SE };
+
+    // the step of each ActionType along the rows (x) and the columns (y) of a grid, indexed by it
+    constexpr int ACTION_DX[STAY + 1] = { -1, -1, -1, 0, 0, 1, 1, 1, 0 };
+    constexpr int ACTION_DY[STAY + 1] = { 0, 1, -1, 1, -1, 1, -1, 0, 0 };
+
+    // move onto one of the cells of the mask, each equally likely (STAY if the mask is empty)
+    // note: exactly one number is drawn for a non-empty mask, same as picking from the list of cell indices
+    inline ActionType pickAction(unsigned int mask, Random &rng) {
+        if (mask == 0) return STAY;
+#if defined(__GNUC__)
+        unsigned int k = (unsigned int) (rng() % (unsigned int) __builtin_popcount(mask));
+        for (; k > 0; --k) mask &= mask - 1;        // drop the k lowest cells
+        return CELL_ACTIONS[__builtin_ctz(mask)];
+#else
+        unsigned int count = 0;
+        for (unsigned int m = mask; m; m &= m - 1) ++count;
+        unsigned int k = (unsigned int) (rng() % count);
+        for (; k > 0; --k) mask &= mask - 1;
+        unsigned int i = 0;
+        while (!(mask & (1u << i))) ++i;
+        return CELL_ACTIONS[i];
+#endif
+    }
+
     class PositionRandomizer {
-        std::default_random_engine __gen;
+        Random __gen;
         std::uniform_int_distribution<int> *__dist[10];
 
     public:
-        PositionRandomizer() {
+        PositionRandomizer() : __gen(std::default_random_engine::default_seed) {
             for (int i = 0; i < 10; i++)
                 __dist[i] = new std::uniform_int_distribution<int>(0, i);
         }
@@ -49,9 +139,14 @@ namespace Gaming {
         }
 
         const Position operator()(const std::vector<int> &positionIndices) {
+            return (*this)(positionIndices, __gen);
+        }
+
+        // draw from the given source instead of the randomizer's own
+        const Position operator()(const std::vector<int> &positionIndices, Random &rng) {
             if (positionIndices.size() == 0) throw PosVectorEmptyEx();
 
-            int posIndex = (*__dist[positionIndices.size() - 1])(__gen);
+            int posIndex = (*__dist[positionIndices.size() - 1])(rng);
             return Position(
                     (unsigned) (positionIndices[posIndex] / 3),
                     (unsigned) (positionIndices[posIndex] % 3));
@@ -5,6 +5,16 @@
 #include <iostream>
 #include <cassert>
 #include <regex>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <map>
 
 #include "GamingTests.h"
 #include "Game.h"
@@ -12,7 +22,14 @@
 #include "Strategic.h"
 #include "Food.h"
 #include "Advantage.h"
+#include "DefaultAgentStrategy.h"
 #include "AggressiveAgentStrategy.h"
+#include "PieceArena.h"
+#include "NeighborhoodCodes.h"
+#include "EventLog.h"
+#include "PieceVisitor.h"
+#include "TimingWheel.h"
+#include "Snapshot.h"
 
 using namespace Gaming;
 using namespace Testing;
@@ -24,8 +41,94 @@ using namespace Testing;
 
 // - - - - - - - - - - helper functions - - - - - - - - - -
 
+// the grid of a game as type/energy pairs (ids are process-wide, so they are left out)
+static std::string gridState(const Game &g) {
+    std::stringstream ss;
+    for (unsigned x = 0; x < g.getHeight(); ++x)
+        for (unsigned y = 0; y < g.getWidth(); ++y)
+            try {
+                const Piece *piece = g.getPiece(x, y);
+                ss << piece->getType() << ':';
+                const Agent *agent = dynamic_cast<const Agent *>(piece);
+                const Resource *resource = dynamic_cast<const Resource *>(piece);
+                if (agent) ss << agent->getEnergy();
+                if (resource) ss << resource->getCapacity();
+                ss << ' ';
+            } catch (PositionEmptyEx &ex) {
+                ss << "- ";
+            }
+    return ss.str();
+}
+
+// whether the surroundings of every cell of a game agree with the pieces around it
+static bool surroundingsMatch(const Game &g) {
+    for (unsigned x = 0; x < g.getHeight(); ++x)
+        for (unsigned y = 0; y < g.getWidth(); ++y) {
+            Surroundings s = g.getSurroundings(Position(x, y));
+            for (int i = 0; i < 9; ++i) {
+                unsigned nx = x + i / 3 - 1, ny = y + i % 3 - 1;
+                PieceType type = SELF;
+                if (i == 4) {
+                    // the cell itself
+                } else if (nx >= g.getHeight() || ny >= g.getWidth()) {
+                    type = INACCESSIBLE;
+                } else {
+                    try {
+                        type = g.getPiece(nx, ny)->getType();
+                    } catch (PositionEmptyEx &ex) {
+                        type = EMPTY;
+                    }
+                }
+                if (s.array[i] != type) return false;
+            }
+        }
+    return true;
+}
+
+// the move onto a uniformly drawn cell of the first non-empty group of piece types
+// (reference for the decisions of the agents, picking from a list of cell indices)
+static ActionType listPick(const Surroundings &s, const std::vector<std::vector<PieceType> > &groups, Random &rng) {
+    static const ActionType actions[9] = { NW, N, NE, W, STAY, E, SW, S, SE };
+    std::vector<int> positions;
+    for (auto group = groups.begin(); group != groups.end() && positions.empty(); ++group)
+        for (int i = 0; i < 9; ++i)
+            if (std::find(group->begin(), group->end(), s.array[i]) != group->end())
+                positions.push_back(i);
+    if (positions.empty()) return STAY;
+    return actions[positions[rng() % positions.size()]];
+}
+
 // - - - - - - - - - - local classes - - - - - - - - - -
 
+// stays put, checking that the surroundings it is handed are those of its cell in the game
+class WatchingStrategy : public Strategy {
+    const Game &__game;
+    Position __position;
+    bool __typeDriven;
+    mutable unsigned __numTurns = 0, __numMismatches = 0;
+
+public:
+    WatchingStrategy(const Game &g, const Position &p, bool typeDriven = false) :
+            __game(g), __position(p), __typeDriven(typeDriven) {}
+
+    unsigned getNumTurns() const { return __numTurns; }
+    unsigned getNumMismatches() const { return __numMismatches; }
+
+    ActionType operator()(const Surroundings &s) const override {
+        ++__numTurns;
+        if (s.array != __game.getSurroundings(__position).array) ++__numMismatches;
+        return STAY;
+    }
+
+    Strategy *clone() const override { return new WatchingStrategy(*this); }
+    bool isTypeDriven() const override { return __typeDriven; }
+};
+
+// stays put and keeps the default clone(), so a Game holding it can't be copied
+class StayingStrategy : public Strategy {
+public:
+    ActionType operator()(const Surroundings &) const override { return STAY; }
+};
 
 // - - - - - - - - - - T E S T S - - - - - - - - - -
 
@@ -555,6 +658,31 @@ void test_piece_turntaking(ErrorContext &ec, unsigned int numRuns) {
 
             ec.result(pass);
         }
+
+        ec.DESC("random surroundings, choices same as picking from cell lists");
+
+        {
+            Random gen(2312 + run), rng(7), ref(7);
+            DefaultAgentStrategy def;
+            AggressiveAgentStrategy strong(Game::STARTING_AGENT_ENERGY), weak(0);
+            const PieceType types[] = { SIMPLE, STRATEGIC, FOOD, ADVANTAGE, INACCESSIBLE, EMPTY };
+
+            pass = true;
+            for (int i = 0; i < 2000; i++) {
+                Surroundings surr;
+                for (int c = 0; c < 9; c++) surr.array[c] = types[gen() % 6];
+                surr.array[4] = SELF;
+                surr.rng = &rng;
+
+                pass = pass &&
+                       (Simple::chooseAction(surr) == listPick(surr, { { ADVANTAGE, FOOD }, { EMPTY } }, ref)) &&
+                       (def(surr) == listPick(surr, { { ADVANTAGE }, { FOOD }, { EMPTY }, { SIMPLE } }, ref)) &&
+                       (strong(surr) == listPick(surr, { { SIMPLE, STRATEGIC }, { ADVANTAGE }, { EMPTY }, { FOOD } }, ref)) &&
+                       (weak(surr) == listPick(surr, { { ADVANTAGE }, { EMPTY }, { FOOD } }, ref));
+            }
+
+            ec.result(pass);
+        }
     }
 }
 
@@ -633,6 +761,269 @@ void test_piece_interaction(ErrorContext &ec, unsigned int numRuns) {
 
             ec.result(pass);
         }
+
+        ec.DESC("3x3, manual, a registered interaction between resources");
+
+        {
+            Game g;
+
+            Food s0(g, Position(2, 0), Game::STARTING_RESOURCE_CAPACITY);
+            Food s1(g, Position(1, 1), Game::STARTING_RESOURCE_CAPACITY);
+
+            Interaction stay = g.getInteraction(FOOD, FOOD);
+            g.setInteraction(FOOD, FOOD, [](Piece &piece, Piece &other) -> Piece & {
+                static_cast<Resource &>(other).consume();
+                return piece;
+            });
+
+            Piece *pieces[2] = { &s0, &s1 };
+            Piece &p0 = *pieces[0], &p1 = *pieces[1];
+            p1 * p0;
+            pass = (! p0.isViable()) && p1.isViable();
+
+            g.setInteraction(FOOD, FOOD, stay);
+            p0 * p1;
+            pass = pass && p1.isViable();
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, interactions are set up per game");
+
+        {
+            Game g0(3, 3, true, 2312 + run), g1(3, 3, true, 2312 + run);
+            for (Game *g : { &g0, &g1 })
+                for (unsigned x = 0; x < 3; ++x)
+                    for (unsigned y = 0; y < 3; ++y)
+                        if (x == 1 && y == 1) g->addSimple(Position(x, y), Game::STARTING_AGENT_ENERGY);
+                        else g->addFood(x, y);
+
+            // note: the agent bounces off the food in g0 only
+            g0.setInteraction(SIMPLE, FOOD, [](Piece &piece, Piece &) -> Piece & { return piece; });
+            g0.round(); g1.round();
+
+            pass = (g0.getNumResources() == 8) && (g1.getNumResources() == 7) &&
+                   (g0.getPiece(1, 1)->getType() == SIMPLE) &&
+                   (g1.getInteraction(SIMPLE, FOOD) == Piece::DEFAULT_INTERACTIONS[SIMPLE][FOOD]);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, the SOA_GRID backend rejects interactions of its own");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            Interaction bounce = [](Piece &piece, Piece &) -> Piece & { return piece; };
+
+            g.setInteraction(SIMPLE, FOOD, bounce);
+            pass = false;
+            try {
+                g.setBackend(Game::SOA_GRID);
+            } catch (UnsupportedEx &ex) {
+                pass = (g.getBackend() == Game::OBJECT_GRID);
+            }
+
+            g.setInteraction(SIMPLE, FOOD, Piece::DEFAULT_INTERACTIONS[SIMPLE][FOOD]);
+            g.setBackend(Game::SOA_GRID);
+            try {
+                g.setInteraction(SIMPLE, FOOD, bounce);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                pass = pass && (g.getInteraction(SIMPLE, FOOD) == Piece::DEFAULT_INTERACTIONS[SIMPLE][FOOD]);
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, synchronous rounds reject interactions of their own");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            Interaction bounce = [](Piece &piece, Piece &) -> Piece & { return piece; };
+
+            g.setInteraction(STRATEGIC, SIMPLE, bounce);
+            pass = false;
+            try {
+                g.setUpdate(Game::SYNCHRONOUS);
+            } catch (UnsupportedEx &ex) {
+                pass = (g.getUpdate() == Game::SEQUENTIAL);
+            }
+
+            g.setInteraction(STRATEGIC, SIMPLE, Piece::DEFAULT_INTERACTIONS[STRATEGIC][SIMPLE]);
+            g.setUpdate(Game::SYNCHRONOUS);
+            try {
+                g.setInteraction(STRATEGIC, SIMPLE, bounce);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                pass = pass && (g.getInteraction(STRATEGIC, SIMPLE) == Piece::DEFAULT_INTERACTIONS[STRATEGIC][SIMPLE]);
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, interactions of no actual piece (exception generated)");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            Interaction bounce = [](Piece &piece, Piece &) -> Piece & { return piece; };
+
+            pass = true;
+            try {
+                g.setInteraction(SELF, EMPTY, bounce);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                std::cerr << "Exception generated: " << ex << std::endl;
+            }
+            try {
+                g.setInteraction(SIMPLE, INACCESSIBLE, bounce);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                std::cerr << "Exception generated: " << ex << std::endl;
+            }
+            try {
+                g.getInteraction(EMPTY, FOOD);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                std::cerr << "Exception generated: " << ex << std::endl;
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, a null interaction (exception generated)");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+
+            try {
+                g.setInteraction(SIMPLE, FOOD, nullptr);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                std::cerr << "Exception generated: " << ex << std::endl;
+                pass = (g.getInteraction(SIMPLE, FOOD) == Piece::DEFAULT_INTERACTIONS[SIMPLE][FOOD]);
+            }
+
+            ec.result(pass);
+        }
+    }
+}
+
+// an agent which isn't one of the built-in pieces
+class Sitter : public Agent {
+public:
+    Sitter(const Game &g, const Position &p, double energy) : Agent(g, p, energy) {}
+    PieceType getType() const override { return PieceType::SIMPLE; }
+    void print(std::ostream &os) const override { os << 'Z' << __id; }
+    ActionType takeTurn(const Surroundings &) const override { return STAY; }
+};
+
+// the class of a piece as seen by visitPiece
+struct ClassName {
+    std::string operator()(Simple &) const { return "Simple"; }
+    std::string operator()(Strategic &) const { return "Strategic"; }
+    std::string operator()(Food &) const { return "Food"; }
+    std::string operator()(Advantage &) const { return "Advantage"; }
+    std::string operator()(Piece &) const { return "Piece"; }
+};
+
+// Static dispatch over the built-in pieces
+void test_piece_visit(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Piece - Static dispatch ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("built-in pieces are visited as their own classes");
+
+        {
+            Game g;
+
+            Simple s0(g, Position(0, 0), Game::STARTING_AGENT_ENERGY);
+            Strategic s1(g, Position(0, 1), Game::STARTING_AGENT_ENERGY);
+            Food s2(g, Position(0, 2), Game::STARTING_RESOURCE_CAPACITY);
+            Advantage s3(g, Position(1, 0), Game::STARTING_RESOURCE_CAPACITY);
+            Simple s4(g, s0);
+
+            pass = (visitPiece(s0, ClassName()) == "Simple") &&
+                   (visitPiece(s1, ClassName()) == "Strategic") &&
+                   (visitPiece(s2, ClassName()) == "Food") &&
+                   (visitPiece(s3, ClassName()) == "Advantage") &&
+                   (visitPiece(s4, ClassName()) == "Simple");
+
+            ec.result(pass);
+        }
+
+        ec.DESC("other pieces are visited through the virtual functions");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            g.addFood(0, 1);
+
+            Sitter z(g, Position(0, 0), Game::STARTING_AGENT_ENERGY);
+
+            pass = (visitPiece(z, ClassName()) == "Piece") &&
+                   (z.getType() == SIMPLE) &&
+                   (z.takeTurn(g.getSurroundings(z.getPosition())) == STAY);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Mobile and immobile pieces
+void test_piece_mobility(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Piece - Mobility ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("agents are mobile, resources immobile");
+
+        {
+            Game g;
+
+            Simple s0(g, Position(0, 0), Game::STARTING_AGENT_ENERGY);
+            Strategic s1(g, Position(0, 1), Game::STARTING_AGENT_ENERGY);
+            Food s2(g, Position(0, 2), Game::STARTING_RESOURCE_CAPACITY);
+            Advantage s3(g, Position(1, 0), Game::STARTING_RESOURCE_CAPACITY);
+            Sitter z(g, Position(1, 1), Game::STARTING_AGENT_ENERGY);
+
+            pass = s0.isMobile() && s1.isMobile() && !s2.isMobile() && !s3.isMobile() && z.isMobile();
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, only the mobile pieces take turns");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            WatchingStrategy *watcher = new WatchingStrategy(g, Position(1, 1));
+            g.addStrategic(1, 1, watcher);
+            for (unsigned x = 0; x < 3; ++x)
+                for (unsigned y = 0; y < 3; ++y)
+                    if (x != 1 || y != 1) {
+                        if ((x + y) % 2) g.addFood(x, y);
+                        else g.addAdvantage(x, y);
+                    }
+
+            for (int r = 0; r < 3; r++) g.round();
+
+            const Resource *food = dynamic_cast<const Resource *>(g.getPiece(0, 1));
+            pass = (watcher->getNumTurns() == 3) && (watcher->getNumMismatches() == 0) &&
+                   (g.getNumResources() == 8) && (food != nullptr) &&
+                   (std::fabs(food->getCapacity() -
+                              (Game::STARTING_RESOURCE_CAPACITY - 3 * Resource::RESOURCE_SPOIL_FACTOR)) < 1e-9);
+
+            ec.result(pass);
+        }
     }
 }
 
@@ -1055,6 +1446,34 @@ void test_game_populate(ErrorContext &ec, unsigned int numRuns) {
 
             ec.result(pass);
         }
+
+        ec.DESC("9x9 grid, auto population, counts follow the rounds");
+
+        {
+            Game g(9, 9, false);
+
+            pass = true;
+            for (int r = 0; r < 10 && g.getStatus() != Game::OVER; r++) {
+                g.round();
+
+                unsigned counts[4] = { 0, 0, 0, 0 };
+                for (unsigned x = 0; x < 9; ++x)
+                    for (unsigned y = 0; y < 9; ++y)
+                        try {
+                            ++counts[g.getPiece(x, y)->getType()];
+                        } catch (PositionEmptyEx &ex) {
+                            continue;
+                        }
+
+                pass = pass &&
+                       (g.getNumSimple() == counts[PieceType::SIMPLE]) &&
+                       (g.getNumStrategic() == counts[PieceType::STRATEGIC]) &&
+                       (g.getNumResources() == counts[PieceType::FOOD] + counts[PieceType::ADVANTAGE]) &&
+                       (g.getNumPieces() == counts[0] + counts[1] + counts[2] + counts[3]);
+            }
+
+            ec.result(pass);
+        }
     }
 }
 
@@ -1336,6 +1755,61 @@ void test_game_print(ErrorContext &ec, unsigned int numRuns) {
 
             ec.result(pass);
         }
+
+        ec.DESC("12x9 grid, auto, board prints as its pieces, status included");
+
+        {
+            Game g(12, 9, false, 2312 + run);
+            for (int r = 0; r < 3; r++) g.round();
+
+            std::stringstream expected;
+            expected << "Round 3" << std::endl;
+            for (unsigned x = 0; x < 9; x++) {
+                for (unsigned y = 0; y < 12; y++)
+                    try {
+                        const Piece *piece = g.getPiece(x, y);
+                        expected << '[' << *piece << ']';
+                    } catch (PositionEmptyEx &ex) {
+                        expected << "[     ]";
+                    }
+                expected << std::endl;
+            }
+            expected << "Status: Not Started..." << std::endl;
+
+            std::stringstream ss;
+            ss << g;
+            pass = (ss.str() == expected.str());
+
+            ec.result(pass);
+        }
+
+        ec.DESC("12x9 grid, auto, the same game printed on 4 threads at once");
+
+        {
+            Game g(12, 9, false, 2312 + run);
+            for (int r = 0; r < 3; r++) g.round();
+
+            std::stringstream once;
+            once << g;
+            const std::string expected = once.str();
+
+            const Game &board = g;
+            std::vector<unsigned> mismatches(4, 0);
+            std::vector<std::thread> threads;
+            for (unsigned t = 0; t < 4; t++)
+                threads.emplace_back([&board, &expected, &mismatches, t]() {
+                    for (int i = 0; i < 50; i++) {
+                        std::stringstream ss;
+                        ss << board;
+                        if (ss.str() != expected) ++mismatches[t];
+                    }
+                });
+            for (auto &thread : threads) thread.join();
+
+            pass = (std::count(mismatches.begin(), mismatches.end(), 0u) == 4);
+
+            ec.result(pass);
+        }
     }
 }
 
@@ -1396,6 +1870,42 @@ void test_game_randomization(ErrorContext &ec, unsigned int numRuns) {
             ec.result(pass);
         }
 
+        ec.DESC("seeded games play out identically");
+
+        {
+            Game g0(9, 9, false, 2312), g1(9, 9, false, 2312);
+
+            pass = (g0.getSeed() == 2312) && (gridState(g0) == gridState(g1));
+            for (int r = 0; r < 10; r++) {
+                g0.round(); g1.round();
+                pass = pass && (gridState(g0) == gridState(g1));
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("looking ahead on the surroundings of a game leaves its play alone");
+
+        {
+            Game g0(9, 9, false, 2312), g1(9, 9, false, 2312);
+            DefaultAgentStrategy strategy;
+
+            pass = true;
+            for (int r = 0; r < 10; r++) {
+                for (unsigned x = 0; x < 9; x++)
+                    for (unsigned y = 0; y < 9; y++) {
+                        Surroundings s = g1.getSurroundings(Position(x, y));
+                        pass = pass && (s.rng == nullptr);
+                        Simple::chooseAction(s);
+                        strategy(s);
+                    }
+                g0.round(); g1.round();
+                pass = pass && (gridState(g0) == gridState(g1));
+            }
+
+            ec.result(pass);
+        }
+
         ec.DESC("random walk of a Simple agent");
 
         {
@@ -1650,3 +2160,1404 @@ void test_game_play(ErrorContext &ec, unsigned int numRuns) {
         }
     }
 }
+
+// Storage backends of a game
+void test_game_backend(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Backends ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("4x5 grid, manual, SoA surroundings match object surroundings");
+
+        {
+            Game g(4, 5);
+
+            g.addSimple(0, 1);
+            g.addAdvantage(1, 0);
+            g.addAdvantage(1, 1);
+            g.addFood(1, 3);
+            g.addStrategic(2, 2);
+            g.addFood(3, 1);
+            g.addSimple(3, 2);
+            g.addStrategic(4, 3);
+
+            std::vector<Surroundings> expected;
+            for (unsigned x = 0; x < 5; x++)
+                for (unsigned y = 0; y < 4; y++)
+                    expected.push_back(g.getSurroundings(Position(x, y)));
+
+            g.setBackend(Game::SOA_GRID);
+
+            pass = (g.getBackend() == Game::SOA_GRID);
+            for (unsigned x = 0; x < 5; x++)
+                for (unsigned y = 0; y < 4; y++)
+                    pass = pass && (g.getSurroundings(Position(x, y)).array == expected[y + x * 4].array);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, SoA, 1 default strategic, 1 simple, 3 resources");
+
+        {
+            Game g;
+            g.setBackend(Game::SOA_GRID);
+            g.addSimple(0, 0);
+            g.addStrategic(0, 1);
+            g.addFood(0, 2);
+            g.addFood(2, 2);
+            g.addAdvantage(1, 0);
+
+            g.play(false);
+
+            pass = (g.getNumResources() == 0) &&
+                   (g.getNumStrategic() == 1) &&
+                   (g.getNumSimple() == 1);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("random walk of a Simple agent, SoA backend");
+
+        {
+            Game g(21, 21);
+            g.setBackend(Game::SOA_GRID);
+            Position pos(10, 10);
+            g.addSimple(Position(pos), 1000 * Game::STARTING_AGENT_ENERGY);
+            const Piece *piece = g.getPiece(pos.x, pos.y);
+
+            pass = true;
+            for (int i = 0; i < 100; i++) {
+                g.round();
+                const Piece *found = nullptr;
+                for (unsigned x = 0; x < 21; x++)
+                    for (unsigned y = 0; y < 21; y++)
+                        try {
+                            found = g.getPiece(x, y);
+                        } catch (PositionEmptyEx &ex) {
+                            continue;
+                        }
+                pos = piece->getPosition();
+                pass = pass && (found == piece) && piece->isViable() &&
+                       (g.getPiece(pos.x, pos.y) == piece);
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("bulk neighborhood codes match per-cell codes on every kernel");
+
+        {
+            Random gen(2312 + run);
+            pass = true;
+            for (unsigned width = 1; width <= 40; width++) {
+                unsigned height = 1 + gen() % 5;
+                std::vector<unsigned char> padded((width + 2) * (height + 2), INACCESSIBLE);
+                for (unsigned x = 0; x < height; x++)
+                    for (unsigned y = 0; y < width; y++)
+                        padded[(x + 1) * (width + 2) + y + 1] = (unsigned char) (gen() % 7);
+
+                for (int kernel = SCALAR_KERNEL; kernel <= AVX2_KERNEL; kernel++) {
+                    std::vector<NeighborhoodCode> codes(width * height, 0);
+                    encodeNeighborhoods(padded.data(), width, height, codes.data(), (NeighborhoodKernel) kernel);
+                    for (unsigned x = 0; x < height; x++)
+                        for (unsigned y = 0; y < width; y++)
+                            pass = pass && (codes[y + x * width] ==
+                                            encodeNeighborhood(&padded[(x + 1) * (width + 2) + y + 1], width + 2));
+                }
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("7x7 grid, manual, SoA turns see the moves made before them");
+
+        {
+            Game g(7, 7, true, 2312 + run);
+            g.setBackend(Game::SOA_GRID);
+            WatchingStrategy *watcher = new WatchingStrategy(g, Position(3, 3));
+            g.addStrategic(3, 3, watcher);
+            for (unsigned i = 0; i < 49; i += 3)
+                if (i != 24) (i % 2) ? g.addSimple(i / 7, i % 7) : g.addFood(i / 7, i % 7);
+
+            for (int r = 0; r < 10; r++) g.round();
+
+            pass = (watcher->getNumTurns() == 10) && (watcher->getNumMismatches() == 0);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("9x9 grid, auto, switching backends keeps the pieces");
+
+        {
+            Game g(9, 9, false);
+
+            g.setBackend(Game::SOA_GRID);
+            for (int i = 0; i < 3; i++) g.round();
+            unsigned numAgents = g.getNumAgents(), numResources = g.getNumResources();
+
+            pass = true;
+            for (unsigned x = 0; x < 9; x++)
+                for (unsigned y = 0; y < 9; y++)
+                    try {
+                        const Piece *piece = g.getPiece(x, y);
+                        pass = pass && piece->getPosition().x == x && piece->getPosition().y == y;
+                    } catch (PositionEmptyEx &ex) {
+                        continue;
+                    }
+
+            g.setBackend(Game::OBJECT_GRID);
+            g.round();
+
+            pass = pass && (g.getBackend() == Game::OBJECT_GRID) &&
+                   (g.getNumAgents() <= numAgents) &&
+                   (g.getNumResources() <= numResources);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Turn order within a round
+void test_game_turns(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Turn order ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("grid order and id order");
+
+        {
+            Game g;
+
+            Food f(g, Position(2, 2), Game::STARTING_RESOURCE_CAPACITY);
+            Simple s(g, Position(0, 1), Game::STARTING_AGENT_ENERGY);
+            Strategic t(g, Position(1, 0), Game::STARTING_AGENT_ENERGY);
+
+            std::vector<Piece *> grid(9, nullptr);
+            grid[1] = &s; grid[3] = &t; grid[8] = &f;
+
+            Random rng(2312);
+            TurnScheduler scheduler;
+            scheduler.schedule(grid, rng);
+            std::vector<Piece *> gridOrder(scheduler.begin(), scheduler.end());
+
+            scheduler.setOrder(TurnScheduler::ID_ORDER);
+            scheduler.schedule(grid, rng);
+            std::vector<Piece *> idOrder(scheduler.begin(), scheduler.end());
+
+            pass = (gridOrder.size() == 3) &&
+                   (gridOrder[0] == &s) && (gridOrder[1] == &t) && (gridOrder[2] == &f) &&
+                   (idOrder.size() == 3) &&
+                   (idOrder[0] == &f) && (idOrder[1] == &s) && (idOrder[2] == &t);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("seeded shuffle is a reproducible permutation");
+
+        {
+            Game g(10, 10);
+
+            std::vector<Piece *> grid(100, nullptr);
+            for (unsigned i = 0; i < 100; i += 3)
+                grid[i] = new Food(g, Position(i / 10, i % 10), Game::STARTING_RESOURCE_CAPACITY);
+
+            TurnScheduler s0(TurnScheduler::SHUFFLED), s1(TurnScheduler::SHUFFLED);
+            Random r0(2312), r1(2312);
+
+            pass = true;
+            for (int r = 0; r < 5; r++) {
+                s0.schedule(grid, r0); s1.schedule(grid, r1);
+                std::vector<Piece *> order(s0.begin(), s0.end());
+                pass = pass && std::equal(s0.begin(), s0.end(), s1.begin()) && (order.size() == 34);
+                std::sort(order.begin(), order.end());
+                pass = pass && (std::unique(order.begin(), order.end()) == order.end());
+            }
+
+            for (auto p : grid) delete p;
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Rounds played on several threads
+void test_game_parallel(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Parallel rounds ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("thread pool runs every task of uneven batches exactly once");
+
+        {
+            ThreadPool pool(4);
+            std::vector<unsigned> counts(1000, 0);
+
+            pass = (pool.size() == 4);
+            for (unsigned batch = 1; batch <= 3; batch++) {
+                pool.parallelFor(1000 / batch, [&](unsigned i) {
+                    if (i % 97 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    ++counts[i];
+                });
+            }
+            for (unsigned i = 0; i < 1000; i++)
+                pass = pass && (counts[i] == (i < 333 ? 3u : i < 500 ? 2u : 1u));
+
+            ec.result(pass);
+        }
+
+        ec.DESC("40x31 grid, auto, same seed plays the same on 2 and 4 threads");
+
+        {
+            Game g0(40, 31, false, 2312), g1(40, 31, false, 2312);
+            g0.setNumThreads(2);
+            g1.setNumThreads(4);
+
+            pass = (g0.getNumThreads() == 2) && (g1.getNumThreads() == 4);
+            for (int r = 0; r < 20; r++) {
+                g0.round(); g1.round();
+                pass = pass && (gridState(g0) == gridState(g1)) &&
+                       (g0.getNumAgents() == g1.getNumAgents()) &&
+                       (g0.getNumResources() == g1.getNumResources());
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("9x9 grid, auto, parallel game plays to the end");
+
+        {
+            Game g(9, 9, false);
+            g.setNumThreads(3);
+
+            g.play(false);
+
+            unsigned numPieces = 0;
+            for (unsigned x = 0; x < 9; ++x)
+                for (unsigned y = 0; y < 9; ++y)
+                    try {
+                        g.getPiece(x, y);
+                        ++numPieces;
+                    } catch (PositionEmptyEx &ex) {
+                        continue;
+                    }
+
+            pass = (g.getStatus() == Game::OVER) &&
+                   (g.getNumResources() == 0) &&
+                   (g.getNumPieces() == numPieces);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Arena storage of pieces
+void test_game_arena(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Arena ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("reserved arena serves 500 pieces from one slab, reuses blocks");
+
+        {
+            PieceArena arena;
+            arena.reserve(500, sizeof(Strategic));
+
+            std::vector<void *> blocks;
+            for (unsigned i = 0; i < 500; i++)
+                blocks.push_back(arena.allocate(i % 2 ? sizeof(Simple) : sizeof(Strategic)));
+            pass = (arena.getNumSlabs() == 1);
+
+            void *freed = blocks[11];
+            arena.release(freed);
+            pass = pass && (arena.allocate(sizeof(Simple)) == freed);
+
+            for (unsigned i = 0; i < 500; i++)
+                pass = pass && (reinterpret_cast<std::uintptr_t>(blocks[i]) % alignof(std::max_align_t) == 0);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, shared and owned strategies play out");
+
+        {
+            Game g;
+
+            g.addStrategic(0, 0);
+            g.addStrategic(2, 2, new AggressiveAgentStrategy(Game::STARTING_AGENT_ENERGY));
+            g.addSimple(1, 1);
+            g.addFood(0, 2);
+            g.addAdvantage(2, 0);
+            g.addFood(1, 0);
+
+            g.play(false);
+
+            pass = (g.getStatus() == Game::OVER) &&
+                   (g.getNumResources() == 0);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Copies and forks of a game
+void test_game_copy(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Copy ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("20x20 grid, auto, mid-game copy plays like the original");
+
+        {
+            Game *g = new Game(20, 20, false, 2312 + run);
+            for (int r = 0; r < 5; r++) g->round();
+
+            Game copy(*g);
+            pass = (copy.getRound() == g->getRound()) &&
+                   (copy.getNumPieces() == g->getNumPieces()) &&
+                   (gridState(copy) == gridState(*g));
+
+            std::vector<std::string> states;
+            for (int r = 0; r < 10; r++) {
+                g->round();
+                states.push_back(gridState(*g));
+            }
+            delete g;
+
+            for (int r = 0; r < 10; r++) {
+                copy.round();
+                pass = pass && (gridState(copy) == states[r]);
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, auto, forks replay per branch, diverge across them");
+
+        {
+            Game g(20, 20, false, 2312 + run);
+            for (int r = 0; r < 5; r++) g.round();
+
+            Game b0 = g.fork(0), b0again = g.fork(0), b1 = g.fork(1);
+            for (int r = 0; r < 10; r++) {
+                b0.round(); b0again.round(); b1.round();
+            }
+
+            pass = (gridState(b0) == gridState(b0again)) &&
+                   (gridState(b0) != gridState(b1)) &&
+                   (g.getRound() == 5);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, SoA, copy keeps backend and owned strategies");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            g.setBackend(Game::SOA_GRID);
+            g.addStrategic(0, 0, new AggressiveAgentStrategy(Game::STARTING_AGENT_ENERGY));
+            g.addStrategic(2, 2);
+            g.addSimple(1, 1);
+            g.addFood(0, 2);
+            g.addAdvantage(2, 0);
+            g.round();
+
+            Game copy(g);
+            pass = (copy.getBackend() == Game::SOA_GRID) &&
+                   (copy.getNumStrategic() == g.getNumStrategic());
+
+            g.play(false);
+            copy.play(false);
+
+            pass = pass && (gridState(copy) == gridState(g)) &&
+                   (copy.getRound() == g.getRound()) &&
+                   (copy.getStatus() == Game::OVER);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, a strategy without a clone (exception generated)");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            g.addStrategic(0, 0, new StayingStrategy());
+            g.addSimple(2, 2);
+
+            try {
+                Game copy(g);
+                pass = false;
+            } catch (UnsupportedEx &ex) {
+                std::cerr << "Exception generated: " << ex << std::endl;
+                pass = (g.getNumPieces() == 2);
+            }
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Snapshots of a game
+void test_game_snapshot(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Snapshot ---");
+
+    const std::string path = "pa4-test.snapshot";
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("20x20 grid, auto, a loaded snapshot plays on like the original");
+
+        {
+            Game g(20, 20, false, 2312 + run);
+            g.setTurnOrder(TurnScheduler::SHUFFLED);
+            for (int r = 0; r < 5; r++) g.round();
+            g.save(path);
+
+            Game loaded(path);
+            std::stringstream ss0, ss1;
+            ss0 << g;
+            ss1 << loaded;
+            pass = (ss0.str() == ss1.str()) &&
+                   (gridState(loaded) == gridState(g)) &&
+                   (loaded.getSeed() == g.getSeed()) &&
+                   (loaded.getTurnOrder() == TurnScheduler::SHUFFLED);
+
+            for (int r = 0; r < 10; r++) {
+                g.round(); loaded.round();
+                pass = pass && (gridState(loaded) == gridState(g));
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, SoA, strategies survive a snapshot");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            g.setBackend(Game::SOA_GRID);
+            g.addStrategic(0, 0, new AggressiveAgentStrategy(Game::STARTING_AGENT_ENERGY));
+            g.addStrategic(2, 2);
+            g.addSimple(1, 1);
+            g.addFood(0, 2);
+            g.addAdvantage(2, 0);
+            g.round();
+            g.save(path);
+
+            Game loaded(path);
+            pass = (loaded.getBackend() == Game::SOA_GRID) &&
+                   (loaded.getRound() == 1) &&
+                   (loaded.getNumStrategic() == g.getNumStrategic());
+
+            g.play(false);
+            loaded.play(false);
+            pass = pass && (gridState(loaded) == gridState(g));
+
+            ec.result(pass);
+        }
+
+        ec.DESC("missing, foreign and truncated files (exception generated)");
+
+        {
+            pass = true;
+            std::remove(path.c_str());
+            try {
+                Game loaded(path);
+                pass = false;
+            } catch (SnapshotEx &ex) {
+                std::cerr << "Exception generated: " << ex << std::endl;
+            }
+
+            {
+                std::ofstream os(path, std::ios::binary);
+                os << "Round 0\n[     ][     ][     ]\n";
+            }
+            try {
+                Game loaded(path);
+                pass = false;
+            } catch (SnapshotEx &ex) {
+                pass = pass && (ex.getReason() == "not a snapshot" || ex.getReason() == "truncated header");
+            }
+
+            Game g(5, 5, false, 2312 + run);
+            g.save(path);
+            {
+                std::ifstream is(path, std::ios::binary);
+                std::string bytes((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+                std::ofstream os(path, std::ios::binary | std::ios::trunc);
+                os.write(bytes.data(), bytes.size() - 1);
+            }
+            try {
+                Game loaded(path);
+                pass = false;
+            } catch (SnapshotEx &ex) {
+                pass = pass && (ex.getReason() == "truncated records");
+            }
+            std::remove(path.c_str());
+
+            ec.result(pass);
+        }
+
+        ec.DESC("sparse board with a cell recorded twice (exception generated)");
+
+        {
+            Game g(5, 5, Game::SPARSE_GRID, 2312 + run);
+            g.addStrategic(0, 0, new AggressiveAgentStrategy(Game::STARTING_AGENT_ENERGY));
+            g.addFood(0, 1);
+            g.save(path);
+            {
+                // note: the food claims the cell of the agent recorded before it
+                std::ifstream is(path, std::ios::binary);
+                std::string bytes((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+                std::size_t last = bytes.size() - Snapshot::RECORD_SIZE;
+                bytes.replace(last, 4, bytes, last - Snapshot::RECORD_SIZE, 4);
+                std::ofstream os(path, std::ios::binary | std::ios::trunc);
+                os.write(bytes.data(), bytes.size());
+            }
+            pass = false;
+            try {
+                Game loaded(path);
+            } catch (SnapshotEx &ex) {
+                pass = (ex.getReason() == "bad record");
+            }
+            std::remove(path.c_str());
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Event logs of a game
+void test_game_events(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Events ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("12x12 grid, auto, logged moves and removals track every piece");
+
+        {
+            pass = true;
+            for (int config = 0; config < 4; config++) {
+                Game g(12, 12, false, 2312 + run);
+                if (config == 1) g.setBackend(Game::SOA_GRID);
+                if (config == 2) g.setNumThreads(3);
+                if (config == 3) g.setUpdate(Game::SYNCHRONOUS);
+
+                std::map<unsigned, std::pair<unsigned, unsigned> > where; // id -> x, y
+                for (unsigned x = 0; x < 12; x++)
+                    for (unsigned y = 0; y < 12; y++)
+                        try {
+                            where[g.getPiece(x, y)->getId()] = std::make_pair(x, y);
+                        } catch (PositionEmptyEx &ex) {
+                            continue;
+                        }
+
+                std::stringstream log;
+                unsigned long numWritten;
+                {
+                    EventLog sink(log, 16);
+                    g.setEventSink(&sink);
+                    for (int r = 0; r < 8; r++) g.round();
+                    g.setEventSink(nullptr);
+                    sink.flush();
+                    numWritten = sink.getNumWritten();
+                }
+
+                std::vector<Event> events;
+                pass = pass && EventLog::read(log, events) && (events.size() == numWritten) && !events.empty();
+
+                unsigned lastRound = 0;
+                for (auto it = events.begin(); it != events.end(); ++it) {
+                    pass = pass && (it->round >= lastRound) && (it->round < 8) && where.count(it->id);
+                    lastRound = it->round;
+                    if (it->kind == Event::MOVE) {
+                        pass = pass && (where[it->id] == std::make_pair(it->from.x, it->from.y));
+                        // the piece moved onto, if any, ends up where the mover came from
+                        for (auto other = where.begin(); other != where.end(); ++other)
+                            if (other->second == std::make_pair(it->to.x, it->to.y))
+                                other->second = std::make_pair(it->from.x, it->from.y);
+                        where[it->id] = std::make_pair(it->to.x, it->to.y);
+                    } else if (it->kind == Event::REMOVE) {
+                        where.erase(it->id);
+                    } else {
+                        pass = pass && where.count(it->otherId) && (it->otherDelta <= 0);
+                    }
+                }
+
+                pass = pass && (where.size() == g.getNumPieces());
+                for (auto it = where.begin(); it != where.end(); ++it)
+                    try {
+                        pass = pass && (g.getPiece(it->second.first, it->second.second)->getId() == it->first);
+                    } catch (PositionEmptyEx &ex) {
+                        pass = false;
+                    }
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("a log with a corrupt block count is rejected before it is read");
+
+        {
+            std::stringstream log;
+            {
+                EventLog sink(log, 16);
+                Event event = { 0, Event::MOVE, 1, 0, Position(0, 0), Position(0, 1), 0.0, 0.0 };
+                sink.record(event);
+            }
+
+            std::string bytes = log.str();
+            pass = (bytes.size() > 12);
+            for (int i = 8; i < 12 && pass; i++) bytes[i] = (char) 0xff; // note: the count of the only block
+
+            std::stringstream corrupt(bytes);
+            std::vector<Event> events;
+            pass = pass && !EventLog::read(corrupt, events) && events.empty();
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Synchronous rounds
+void test_game_synchronous(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Synchronous rounds ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("3x3 grid, manual, of two simple agents the stronger gets the food");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            g.setUpdate(Game::SYNCHRONOUS);
+            g.addSimple(Position(0, 0), 50);
+            g.addFood(0, 1);
+            g.addSimple(Position(0, 2), 30);
+            g.addFood(2, 1);
+
+            const Piece *strong = g.getPiece(0, 0), *weak = g.getPiece(0, 2);
+            g.round();
+
+            pass = (g.getUpdate() == Game::SYNCHRONOUS) &&
+                   (g.getNumResources() == 1) &&
+                   (g.getPiece(0, 1) == strong) &&
+                   (g.getPiece(0, 2) == weak) &&
+                   (strong->getPosition().x == 0 && strong->getPosition().y == 1) &&
+                   (static_cast<const Agent *>(strong)->getEnergy() ==
+                    50 - Agent::AGENT_FATIGUE_RATE + Game::STARTING_RESOURCE_CAPACITY - Resource::RESOURCE_SPOIL_FACTOR);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("40x31 grid, auto, synchronous rounds play the same on 1 and 3 threads");
+
+        {
+            Game g0(40, 31, false, 2312 + run), g1(40, 31, false, 2312 + run);
+            g0.setUpdate(Game::SYNCHRONOUS);
+            g1.setUpdate(Game::SYNCHRONOUS);
+            g1.setNumThreads(3);
+
+            pass = true;
+            for (int r = 0; r < 20; r++) {
+                g0.round(); g1.round();
+                pass = pass && (gridState(g0) == gridState(g1));
+            }
+
+            unsigned numPieces = 0;
+            for (unsigned x = 0; x < 31; ++x)
+                for (unsigned y = 0; y < 40; ++y)
+                    try {
+                        const Piece *piece = g1.getPiece(x, y);
+                        pass = pass && piece->isViable() &&
+                               (piece->getPosition().x == x) && (piece->getPosition().y == y);
+                        ++numPieces;
+                    } catch (PositionEmptyEx &ex) {
+                        continue;
+                    }
+            pass = pass && (g1.getNumPieces() == numPieces);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Sparse grid backend
+void test_game_sparse(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Sparse grid ---");
+
+    const std::string path = "pa4-test-sparse.snapshot";
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("100000x100000 grid, manual, a few pieces on a sparse board");
+
+        {
+            Game g(100000, 100000, Game::SPARSE_GRID, 2312 + run);
+            g.addSimple(Position(50000, 50000), Game::STARTING_AGENT_ENERGY);
+            g.addFood(50000, 50001);
+            g.addFood(99999, 99999);
+
+            Surroundings corner = g.getSurroundings(Position(99999, 99999));
+            pass = (g.getBackend() == Game::SPARSE_GRID) &&
+                   (g.getPiece(50000, 50001)->getType() == FOOD) &&
+                   (corner.array[8] == INACCESSIBLE) && (corner.array[0] == EMPTY);
+
+            g.round();
+            pass = pass && (g.getNumResources() == 1) &&
+                   (g.getPiece(50000, 50001)->getType() == SIMPLE);
+            try {
+                g.getPiece(50000, 50000);
+                pass = false;
+            } catch (PositionEmptyEx &ex) {
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, auto, a sparse board plays like the object grid");
+
+        {
+            Game g0(20, 20, false, 2312 + run), g1(20, 20, false, 2312 + run);
+            g0.setTurnOrder(TurnScheduler::SHUFFLED);
+            g1.setTurnOrder(TurnScheduler::SHUFFLED);
+            g1.setBackend(Game::SPARSE_GRID);
+
+            pass = true;
+            for (int r = 0; r < 30; r++) {
+                g0.round(); g1.round();
+                pass = pass && (gridState(g0) == gridState(g1));
+            }
+            pass = pass && (g0.getNumPieces() == g1.getNumPieces());
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, auto, copies and snapshots of a sparse board");
+
+        {
+            Game g(20, 20, false, 2312 + run);
+            g.setBackend(Game::SPARSE_GRID);
+            for (int r = 0; r < 5; r++) g.round();
+            g.save(path);
+
+            Game loaded(path), copy(g);
+            pass = (loaded.getBackend() == Game::SPARSE_GRID) && (copy.getBackend() == Game::SPARSE_GRID) &&
+                   (gridState(loaded) == gridState(g)) && (gridState(copy) == gridState(g));
+
+            for (int r = 0; r < 5; r++) {
+                g.round(); loaded.round(); copy.round();
+            }
+            loaded.setBackend(Game::OBJECT_GRID);
+            pass = pass && (gridState(loaded) == gridState(g)) && (gridState(copy) == gridState(g));
+            std::remove(path.c_str());
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Cell layouts of the object grid
+void test_game_layout(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Cell layouts ---");
+
+    const std::string path = "pa4-test-layout.snapshot";
+    const CellIndex::Layout layouts[3] = { CellIndex::ROW_MAJOR, CellIndex::TILED, CellIndex::MORTON };
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("every layout maps the cells of a board one to one");
+
+        {
+            const unsigned sizes[4][2] = { { 3, 3 }, { 20, 7 }, { 13, 40 }, { 100, 3 } };
+            pass = true;
+            for (int l = 0; l < 3; l++)
+                for (int s = 0; s < 4; s++) {
+                    unsigned width = sizes[s][0], height = sizes[s][1];
+                    CellIndex index(layouts[l], width, height);
+                    std::vector<bool> used(index.size(), false);
+                    pass = pass && (index.size() >= width * height);
+                    for (unsigned x = 0; pass && x < height; ++x)
+                        for (unsigned y = 0; pass && y < width; ++y) {
+                            unsigned i = index(x, y);
+                            pass = (i < index.size()) && !used[i];
+                            if (pass) used[i] = true;
+                        }
+                }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("21x19 grid, auto, every layout plays like row-major");
+
+        {
+            pass = true;
+            for (int config = 0; config < 3; config++)
+                for (int l = 1; l < 3; l++) {
+                    Game g0(21, 19, false, 2312 + run), g1(21, 19, false, 2312 + run);
+                    g1.setLayout(layouts[l]);
+                    if (config == 0) {
+                        g0.setTurnOrder(TurnScheduler::SHUFFLED);
+                        g1.setTurnOrder(TurnScheduler::SHUFFLED);
+                    }
+                    if (config == 1) {
+                        g0.setNumThreads(3);
+                        g1.setNumThreads(3);
+                    }
+                    if (config == 2) {
+                        g0.setUpdate(Game::SYNCHRONOUS);
+                        g1.setUpdate(Game::SYNCHRONOUS);
+                    }
+                    for (int r = 0; r < 15; r++) {
+                        g0.round(); g1.round();
+                        pass = pass && (gridState(g0) == gridState(g1));
+                    }
+                    pass = pass && (g1.getLayout() == layouts[l]);
+                }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, auto, backends, copies and snapshots keep the layout");
+
+        {
+            Game g(20, 20, false, 2312 + run);
+            g.setLayout(CellIndex::MORTON);
+            for (int r = 0; r < 3; r++) g.round();
+            g.setBackend(Game::SOA_GRID);
+            for (int r = 0; r < 3; r++) g.round();
+            g.setBackend(Game::OBJECT_GRID);
+            g.save(path);
+
+            Game loaded(path), copy(g);
+            pass = (g.getLayout() == CellIndex::MORTON) &&
+                   (loaded.getLayout() == CellIndex::MORTON) && (copy.getLayout() == CellIndex::MORTON) &&
+                   (gridState(loaded) == gridState(g)) && (gridState(copy) == gridState(g));
+
+            for (int r = 0; r < 5; r++) {
+                g.round(); loaded.round(); copy.round();
+            }
+            pass = pass && (gridState(loaded) == gridState(g)) && (gridState(copy) == gridState(g));
+            std::remove(path.c_str());
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Live piece tracking
+void test_game_live(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Live pieces ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("300x300 grid, manual, a few pieces play alike on every board");
+
+        {
+            Game g0(300, 300, true, 2312 + run), g1(300, 300, Game::SPARSE_GRID, 2312 + run);
+            Random rng(2312 + run);
+            for (int i = 0; i < 60; i++) {
+                Position pos(rng() % 300, rng() % 300);
+                try {
+                    if (i % 3 == 0) { g0.addSimple(pos); g1.addSimple(pos); }
+                    else if (i % 3 == 1) { g0.addStrategic(pos); g1.addStrategic(pos); }
+                    else { g0.addFood(pos); g1.addFood(pos); }
+                } catch (PositionNonemptyEx &ex) {
+                    continue;
+                }
+            }
+
+            pass = true;
+            for (int r = 0; r < 5; r++) {
+                g0.round(); g1.round();
+            }
+            Game copy(g0);
+            for (int r = 0; r < 5; r++) {
+                g0.round(); g1.round(); copy.round();
+                pass = pass && (gridState(g0) == gridState(g1)) && (gridState(copy) == gridState(g0));
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, auto, piece counts follow the board in every mode");
+
+        {
+            pass = true;
+            for (int config = 0; config < 4; config++) {
+                Game g(20, 20, false, 2312 + run);
+                if (config == 1) g.setNumThreads(3);
+                if (config == 2) g.setUpdate(Game::SYNCHRONOUS);
+                if (config == 3) g.setBackend(Game::SOA_GRID);
+
+                for (int r = 0; r < 20 && g.getStatus() != Game::OVER; r++) {
+                    g.round();
+
+                    unsigned numPieces = 0, numResources = 0;
+                    for (unsigned x = 0; x < 20; ++x)
+                        for (unsigned y = 0; y < 20; ++y)
+                            try {
+                                PieceType type = g.getPiece(x, y)->getType();
+                                ++numPieces;
+                                if (type == FOOD || type == ADVANTAGE) ++numResources;
+                            } catch (PositionEmptyEx &ex) {
+                                continue;
+                            }
+                    pass = pass && (g.getNumPieces() == numPieces) && (g.getNumResources() == numResources);
+                }
+            }
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Fast-forward to the end of a game
+void test_game_fastforward(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Fast-forward ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("10x10 grid, resources only, over in the round they would spoil");
+
+        {
+            Game g0(10, 10, true, 2312 + run), g1(10, 10, true, 2312 + run);
+            g1.setFastForward(true);
+            for (unsigned i = 0; i < 10; i++) {
+                g0.addFood(i, i); g1.addFood(i, i);
+                g0.addAdvantage(i, 9 - i); g1.addAdvantage(i, 9 - i);
+            }
+
+            while (g0.getStatus() != Game::OVER) g0.round();
+            g1.round();
+
+            pass = g1.getFastForward() && (g1.getStatus() == Game::OVER) &&
+                   (g1.getRound() == g0.getRound()) && (g1.getNumPieces() == 0);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, agents far from the resources age in closed form");
+
+        {
+            Game g(20, 20, true, 2312 + run);
+            g.setFastForward(true);
+            g.addSimple(Position(0, 0), 20);
+            g.addSimple(Position(0, 19), 2);    // gone after 7 rounds
+            g.addFood(19, 19);                  // spoils in 9 rounds
+
+            g.round();
+
+            pass = (g.getStatus() == Game::OVER) && (g.getRound() == 9) && (g.getNumPieces() == 1);
+            if (pass) {
+                const Agent *agent = dynamic_cast<const Agent *>(g.getPiece(0, 0));
+                pass = agent && std::fabs(agent->getEnergy() - (20 - 9 * Agent::AGENT_FATIGUE_RATE)) < 1e-9;
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, an agent near a resource, rounds played one by one");
+
+        {
+            Game g(20, 20, true, 2312 + run);
+            g.setFastForward(true);
+            g.addSimple(Position(0, 0), 20);
+            g.addFood(5, 5);
+
+            g.round();
+
+            pass = (g.getRound() == 1) && (g.getNumPieces() == 2);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("100x100 grid, tired agents look around as far as they can go");
+
+        {
+            Game g0(100, 100, true, 2312 + run), g1(100, 100, true, 2312 + run);
+            for (Game *g : { &g0, &g1 }) {
+                g->setFastForward(true);
+                for (unsigned y = 0; y < 100; y++) {
+                    g->addFood(0, y);
+                    g->addFood(1, y);
+                }
+                for (unsigned y = 0; y < 100; y += 10) g->addSimple(Position(90, y), 1);  // gone after 4 rounds
+            }
+            g1.addSimple(Position(5, 50), 1);   // 4 cells from the food
+
+            g0.round(); g1.round();
+
+            pass = (g0.getStatus() == Game::OVER) && (g0.getRound() == 9) && (g0.getNumPieces() == 0) &&
+                   (g1.getRound() == 1) && (g1.getNumResources() == 200);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Lazy spoilage of resources
+void test_game_spoilage(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Spoilage ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("timing wheel, pieces a lap apart share a bucket");
+
+        {
+            Game g;
+            Food f0(g, Position(0, 0), 1), f1(g, Position(0, 1), 1), f2(g, Position(0, 2), 1);
+            TimingWheel wheel(8);
+            wheel.add(&f0, 3 + run);
+            wheel.add(&f1, 11 + run);
+            wheel.add(&f2, 3 + run);
+
+            std::vector<Piece *> due;
+            wheel.collect(3 + run, due);
+            pass = (wheel.size() == 3) && (due.size() == 2);
+
+            wheel.remove(&f0, 3 + run);
+            due.clear();
+            wheel.collect(3 + run, due);
+            pass = pass && (due.size() == 1) && (due[0] == &f2);
+
+            due.clear();
+            wheel.collect(11 + run, due);
+            pass = pass && (due.size() == 1) && (due[0] == &f1) && (wheel.size() == 2);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("5x5 grid, manual, resources spoil from the round they are added in");
+
+        {
+            Game g(5, 5, true, 2312 + run);
+            g.addFood(0, 0);
+            for (int r = 0; r < 3; r++) g.round();
+            g.addAdvantage(4, 4);
+            g.round();
+
+            const Resource *food = dynamic_cast<const Resource *>(g.getPiece(0, 0));
+            const Resource *advantage = dynamic_cast<const Resource *>(g.getPiece(4, 4));
+            pass = food && advantage &&
+                   (std::fabs(food->getCapacity() -
+                              (Game::STARTING_RESOURCE_CAPACITY - 4 * Resource::RESOURCE_SPOIL_FACTOR)) < 1e-9) &&
+                   (std::fabs(advantage->getCapacity() -
+                              (Game::STARTING_RESOURCE_CAPACITY - Resource::RESOURCE_SPOIL_FACTOR) *
+                              Advantage::ADVANTAGE_MULT_FACTOR) < 1e-9);
+
+            // the food goes at the end of round 9, the advantage 3 rounds later
+            while (g.getStatus() != Game::OVER && g.getNumResources() == 2) g.round();
+            pass = pass && (g.getRound() == 9) && (g.getNumResources() == 1);
+            while (g.getStatus() != Game::OVER) g.round();
+            pass = pass && (g.getRound() == 12);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("20x20 grid, auto, copies and snapshots spoil like the original");
+
+        {
+            const std::string path = "pa4-test.snapshot";
+            Game g(20, 20, false, 2312 + run);
+            for (int r = 0; r < 4; r++) g.round();
+            Game copy(g);
+            g.save(path);
+            Game loaded(path);
+            std::remove(path.c_str());
+
+            pass = true;
+            for (int r = 0; r < 12 && g.getStatus() != Game::OVER; r++) {
+                g.round(); copy.round(); loaded.round();
+                pass = pass && (gridState(copy) == gridState(g)) && (gridState(loaded) == gridState(g)) &&
+                       (copy.getNumResources() == g.getNumResources()) &&
+                       (loaded.getNumResources() == g.getNumResources());
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, resources aged by hand leave when they spoil");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            g.addFood(0, 0);
+            g.addFood(2, 2);
+            for (int a = 0; a < 9; a++) const_cast<Piece *>(g.getPiece(0, 0))->age();
+            for (int a = 0; a < 3; a++) const_cast<Piece *>(g.getPiece(2, 2))->age();
+
+            g.round();
+            pass = (g.getNumResources() == 1);
+
+            // note: the food left with 10 - 3 * 1.2 spoils in the sixth round
+            unsigned rounds = 1;
+            while (g.getNumResources() > 0 && rounds < 20) {
+                pass = pass && g.getPiece(2, 2)->isViable();
+                g.round();
+                ++rounds;
+            }
+            pass = pass && (rounds == 6);
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Neighborhood codes of the object grid
+void test_game_neighborhoods(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Neighborhood codes ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("7x5 grid, manual, surroundings follow additions");
+
+        {
+            Game g(7, 5, true, 2312 + run);
+            pass = surroundingsMatch(g);
+            g.addSimple(Position(0, 0), 10);
+            g.addStrategic(2, 3);
+            g.addFood(4, 6);
+            g.addAdvantage(1, 1);
+            pass = pass && surroundingsMatch(g);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("21x19 grid, auto, surroundings follow the board in every mode");
+
+        {
+            pass = true;
+            for (int config = 0; config < 5; config++) {
+                Game g(21, 19, false, 2312 + run);
+                if (config == 1) g.setNumThreads(3);
+                if (config == 2) g.setUpdate(Game::SYNCHRONOUS);
+                if (config == 3) g.setLayout(CellIndex::MORTON);
+                if (config == 4) g.setTurnOrder(TurnScheduler::SHUFFLED);
+
+                for (int r = 0; r < 12 && g.getStatus() != Game::OVER; r++) {
+                    g.round();
+                    pass = pass && surroundingsMatch(g);
+                }
+            }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("21x19 grid, auto, surroundings survive backends and copies");
+
+        {
+            Game g(21, 19, false, 2312 + run);
+            g.setBackend(Game::SOA_GRID);
+            for (int r = 0; r < 3; r++) g.round();
+            g.setBackend(Game::OBJECT_GRID);
+            pass = surroundingsMatch(g);
+
+            g.setBackend(Game::SPARSE_GRID);
+            g.round();
+            g.setBackend(Game::OBJECT_GRID);
+            pass = pass && surroundingsMatch(g);
+
+            Game copy(g);
+            g.round(); copy.round();
+            pass = pass && surroundingsMatch(copy) && (gridState(copy) == gridState(g));
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Agents without options sleeping through their turns
+void test_game_quiescence(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Quiescence ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("3x3 grid, manual, a boxed-in agent is asked once and ages every round");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            WatchingStrategy *sleeper = new WatchingStrategy(g, Position(1, 1), true);
+            WatchingStrategy *watcher = new WatchingStrategy(g, Position(0, 0));
+            for (unsigned x = 0; x < 3; ++x)
+                for (unsigned y = 0; y < 3; ++y)
+                    if (x == 1 && y == 1) g.addStrategic(x, y, sleeper);
+                    else if (x == 0 && y == 0) g.addStrategic(x, y, watcher);
+                    else g.addSimple(Position(x, y), 100);
+
+            for (int r = 0; r < 5; r++) g.round();
+
+            const Agent *agent = dynamic_cast<const Agent *>(g.getPiece(1, 1));
+            pass = (sleeper->getNumTurns() == 1) && (watcher->getNumTurns() == 5) &&
+                   (agent != nullptr) &&
+                   (std::fabs(agent->getEnergy() - (Game::STARTING_AGENT_ENERGY - 5 * Agent::AGENT_FATIGUE_RATE)) < 1e-9);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("3x3 grid, manual, a boxed-in agent wakes when a neighbor leaves");
+
+        {
+            Game g(3, 3, true, 2312 + run);
+            WatchingStrategy *sleeper = new WatchingStrategy(g, Position(1, 1), true);
+            for (unsigned x = 0; x < 3; ++x)
+                for (unsigned y = 0; y < 3; ++y)
+                    if (x == 1 && y == 1) g.addStrategic(x, y, sleeper);
+                    else g.addSimple(Position(x, y), (x == 2 && y == 2) ? 0.5 : 100);
+
+            g.round(); g.round();
+            pass = (sleeper->getNumTurns() == 1) && (g.getNumAgents() == 8);
+
+            g.round();
+            pass = pass && (sleeper->getNumTurns() == 2) && (sleeper->getNumMismatches() == 0);
+
+            ec.result(pass);
+        }
+
+        ec.DESC("12x12 grid, manual, a crowd plays like the sparse grid");
+
+        {
+            Game g0(12, 12, true, 2312 + run), g1(12, 12, Game::SPARSE_GRID, 2312 + run);
+            for (unsigned x = 0; x < 12; ++x)
+                for (unsigned y = 0; y < 12; ++y)
+                    for (Game *g : { &g0, &g1 }) {
+                        unsigned kind = (x * 12 + y) * 7 % 10;
+                        if (kind < 6) g->addSimple(Position(x, y), 1 + (x * 5 + y * 3) % 9);
+                        else if (kind == 6) g->addStrategic(x, y);
+                        else if (kind == 7)
+                            g->addStrategic(x, y, new AggressiveAgentStrategy(Game::STARTING_AGENT_ENERGY));
+                        else if (kind == 8) g->addFood(x, y);
+                    }
+
+            pass = (gridState(g0) == gridState(g1));
+            for (int r = 0; r < 30; r++) {
+                g0.round(); g1.round();
+                pass = pass && (gridState(g0) == gridState(g1));
+            }
+
+            ec.result(pass);
+        }
+    }
+}
+
+// Legal moves on the edges of the grid
+void test_game_moves(ErrorContext &ec, unsigned int numRuns) {
+    bool pass;
+
+    // Run at least once!!
+    assert(numRuns > 0);
+
+    ec.DESC("--- Test - Game - Moves ---");
+
+    for (int run = 0; run < numRuns; run++) {
+
+        ec.DESC("5x4 grid, every action from every cell");
+
+        {
+            Game g(5, 4);
+            const ActionType actions[] = { N, NE, NW, E, W, SE, SW, S, STAY };
+
+            pass = true;
+            for (unsigned x = 0; x < g.getHeight(); ++x)
+                for (unsigned y = 0; y < g.getWidth(); ++y)
+                    for (ActionType ac : actions) {
+                        int nx = x, ny = y;
+                        if (ac == N || ac == NE || ac == NW) --nx;
+                        if (ac == S || ac == SE || ac == SW) ++nx;
+                        if (ac == W || ac == NW || ac == SW) --ny;
+                        if (ac == E || ac == NE || ac == SE) ++ny;
+                        bool legal = nx >= 0 && nx < (int) g.getHeight() && ny >= 0 && ny < (int) g.getWidth();
+
+                        Position to = g.move(Position(x, y), ac);
+                        pass = pass && (g.isLegal(ac, Position(x, y)) == legal) &&
+                               (to.x == (legal ? (unsigned) nx : x)) && (to.y == (legal ? (unsigned) ny : y));
+                    }
+
+            ec.result(pass);
+        }
+
+        ec.DESC("40x3 grid, auto, surroundings on the edges follow the board");
+
+        {
+            Game g(40, 3, false, 2312 + run);
+
+            pass = surroundingsMatch(g);
+            for (int r = 0; r < 15 && g.getStatus() != Game::OVER; r++) {
+                g.round();
+                pass = pass && surroundingsMatch(g);
+            }
+
+            ec.result(pass);
+        }
+    }
+}
@@ -31,6 +31,12 @@ void test_piece_turntaking(ErrorContext &ec, unsigned int numRuns);
 // Piece interaction operator*
 void test_piece_interaction(ErrorContext &ec, unsigned int numRuns);
 
+// Static dispatch over the built-in pieces
+void test_piece_visit(ErrorContext &ec, unsigned int numRuns);
+
+// Mobile and immobile pieces
+void test_piece_mobility(ErrorContext &ec, unsigned int numRuns);
+
 
 // - - - - - - - - - Tests: struct Surroundings - - - - - - - - - -
 
@@ -64,4 +70,52 @@ void test_game_randomization(ErrorContext &ec, unsigned int numRuns);
 // Playing and termination of a game
 void test_game_play(ErrorContext &ec, unsigned int numRuns);
 
+// Storage backends of a game
+void test_game_backend(ErrorContext &ec, unsigned int numRuns);
+
+// Turn order within a round
+void test_game_turns(ErrorContext &ec, unsigned int numRuns);
+
+// Rounds played on several threads
+void test_game_parallel(ErrorContext &ec, unsigned int numRuns);
+
+// Arena storage of pieces
+void test_game_arena(ErrorContext &ec, unsigned int numRuns);
+
+// Copies and forks of a game
+void test_game_copy(ErrorContext &ec, unsigned int numRuns);
+
+// Snapshots of a game
+void test_game_snapshot(ErrorContext &ec, unsigned int numRuns);
+
+// Event logs of a game
+void test_game_events(ErrorContext &ec, unsigned int numRuns);
+
+// Synchronous rounds
+void test_game_synchronous(ErrorContext &ec, unsigned int numRuns);
+
+// Sparse grid backend
+void test_game_sparse(ErrorContext &ec, unsigned int numRuns);
+
+// Cell layouts of the object grid
+void test_game_layout(ErrorContext &ec, unsigned int numRuns);
+
+// Live piece tracking
+void test_game_live(ErrorContext &ec, unsigned int numRuns);
+
+// Fast-forward to the end of a game
+void test_game_fastforward(ErrorContext &ec, unsigned int numRuns);
+
+// Lazy spoilage of resources
+void test_game_spoilage(ErrorContext &ec, unsigned int numRuns);
+
+// Neighborhood codes of the object grid
+void test_game_neighborhoods(ErrorContext &ec, unsigned int numRuns);
+
+// Agents without options sleeping through their turns
+void test_game_quiescence(ErrorContext &ec, unsigned int numRuns);
+
+// Legal moves on the edges of the grid
+void test_game_moves(ErrorContext &ec, unsigned int numRuns);
+
 #endif //PA5GAME_GAMINGTESTS_H
@@ -0,0 +1,113 @@
+#include "NeighborhoodCodes.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PA5GAME_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Gaming {
+
+    namespace {
+
+        // cells [from, width) of every row: the tails left over by the vector kernels
+        void encodeScalar(const unsigned char *padded, unsigned width, unsigned height,
+                          NeighborhoodCode *codes, unsigned from) {
+            const unsigned stride = width + 2;
+            for (unsigned x = 0; x < height; ++x) {
+                const unsigned char *row = padded + (x + 1) * stride + 1;
+                for (unsigned y = from; y < width; ++y)
+                    codes[x * width + y] = encodeNeighborhood(row + y, stride);
+            }
+        }
+
+#ifdef PA5GAME_X86_KERNELS
+
+        // 16 cells per step, the bytes widened to 32-bit lanes by unpacking with zero
+        __attribute__((target("sse2")))
+        unsigned encodeSSE2(const unsigned char *padded, unsigned width, unsigned height, NeighborhoodCode *codes) {
+            const unsigned stride = width + 2;
+            const int offsets[8] = { -(int) stride - 1, -(int) stride, -(int) stride + 1, -1,
+                                     1, (int) stride - 1, (int) stride, (int) stride + 1 };
+            const __m128i zero = _mm_setzero_si128();
+            const unsigned end = width - width % 16;
+
+            for (unsigned x = 0; x < height; ++x) {
+                const unsigned char *row = padded + (x + 1) * stride + 1;
+                NeighborhoodCode *out = codes + x * width;
+                for (unsigned y = 0; y < end; y += 16) {
+                    __m128i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+                    for (unsigned k = 0; k < 8; ++k) {
+                        __m128i v = _mm_loadu_si128((const __m128i *) (row + y + offsets[k]));
+                        __m128i shift = _mm_cvtsi32_si128(3 * k);
+                        __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+                        acc0 = _mm_or_si128(acc0, _mm_sll_epi32(_mm_unpacklo_epi16(lo, zero), shift));
+                        acc1 = _mm_or_si128(acc1, _mm_sll_epi32(_mm_unpackhi_epi16(lo, zero), shift));
+                        acc2 = _mm_or_si128(acc2, _mm_sll_epi32(_mm_unpacklo_epi16(hi, zero), shift));
+                        acc3 = _mm_or_si128(acc3, _mm_sll_epi32(_mm_unpackhi_epi16(hi, zero), shift));
+                    }
+                    _mm_storeu_si128((__m128i *) (out + y), acc0);
+                    _mm_storeu_si128((__m128i *) (out + y + 4), acc1);
+                    _mm_storeu_si128((__m128i *) (out + y + 8), acc2);
+                    _mm_storeu_si128((__m128i *) (out + y + 12), acc3);
+                }
+            }
+            return end;
+        }
+
+        // 8 cells per step, the bytes zero-extended straight into 32-bit lanes
+        __attribute__((target("avx2")))
+        unsigned encodeAVX2(const unsigned char *padded, unsigned width, unsigned height, NeighborhoodCode *codes) {
+            const unsigned stride = width + 2;
+            const int offsets[8] = { -(int) stride - 1, -(int) stride, -(int) stride + 1, -1,
+                                     1, (int) stride - 1, (int) stride, (int) stride + 1 };
+            const unsigned end = width - width % 8;
+
+            for (unsigned x = 0; x < height; ++x) {
+                const unsigned char *row = padded + (x + 1) * stride + 1;
+                NeighborhoodCode *out = codes + x * width;
+                for (unsigned y = 0; y < end; y += 8) {
+                    __m256i acc = _mm256_setzero_si256();
+                    for (unsigned k = 0; k < 8; ++k) {
+                        __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (row + y + offsets[k])));
+                        acc = _mm256_or_si256(acc, _mm256_sll_epi32(v, _mm_cvtsi32_si128(3 * k)));
+                    }
+                    _mm256_storeu_si256((__m256i *) (out + y), acc);
+                }
+            }
+            return end;
+        }
+
+#endif
+
+    }
+
+    NeighborhoodKernel bestNeighborhoodKernel()
+    {
+#ifdef PA5GAME_X86_KERNELS
+        static const NeighborhoodKernel best =
+                __builtin_cpu_supports("avx2") ? AVX2_KERNEL :
+                __builtin_cpu_supports("sse2") ? SSE2_KERNEL : SCALAR_KERNEL;
+        return best;
+#else
+        return SCALAR_KERNEL;
+#endif
+    }
+
+    void encodeNeighborhoods(const unsigned char *padded, unsigned width, unsigned height,
+                             NeighborhoodCode *codes, NeighborhoodKernel kernel)
+    {
+        if (kernel > bestNeighborhoodKernel()) kernel = bestNeighborhoodKernel();
+
+        unsigned done = 0;
+#ifdef PA5GAME_X86_KERNELS
+        switch (kernel)
+        {
+            case AVX2_KERNEL: done = encodeAVX2(padded, width, height, codes); break;
+            case SSE2_KERNEL: done = encodeSSE2(padded, width, height, codes); break;
+            default: break;
+        }
+#endif
+        if (done < width) encodeScalar(padded, width, height, codes, done);
+    }
+
+}
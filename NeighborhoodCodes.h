@@ -0,0 +1,57 @@
+//
+// Packed 3x3 neighborhood codes over a byte-per-cell type plane
+//
+
+#ifndef PA5GAME_NEIGHBORHOODCODES_H
+#define PA5GAME_NEIGHBORHOODCODES_H
+
+#include <cstdint>
+
+#include "Gaming.h"
+
+namespace Gaming {
+
+    // The PieceTypes of the 8 neighbors of a cell, 3 bits each, in Surroundings
+    // order with the center (always SELF) left out: bits 0-2 hold cell 0 (NW),
+    // bits 21-23 hold cell 8 (SE).
+    typedef std::uint32_t NeighborhoodCode;
+
+    // no cell has this code (only the low 24 bits are ever set)
+    static const NeighborhoodCode NO_NEIGHBORHOOD = ~(NeighborhoodCode) 0;
+
+    // implementations of the bulk encoding, best last
+    enum NeighborhoodKernel { SCALAR_KERNEL = 0, SSE2_KERNEL, AVX2_KERNEL };
+
+    // the best kernel the running CPU supports
+    NeighborhoodKernel bestNeighborhoodKernel();
+
+    // code of a single cell of a padded plane (a row stride apart from the cells above/below)
+    inline NeighborhoodCode encodeNeighborhood(const unsigned char *center, unsigned stride) {
+        return (NeighborhoodCode) center[-(int) stride - 1]
+               | (NeighborhoodCode) center[-(int) stride] << 3
+               | (NeighborhoodCode) center[-(int) stride + 1] << 6
+               | (NeighborhoodCode) center[-1] << 9
+               | (NeighborhoodCode) center[1] << 12
+               | (NeighborhoodCode) center[stride - 1] << 15
+               | (NeighborhoodCode) center[stride] << 18
+               | (NeighborhoodCode) center[stride + 1] << 21;
+    }
+
+    // codes of all the cells of a height x width plane, stored row-major in codes;
+    // padded holds the plane surrounded by a one-cell INACCESSIBLE border (rows of width + 2)
+    // note: an unsupported kernel falls back to the best supported one
+    void encodeNeighborhoods(const unsigned char *padded, unsigned width, unsigned height,
+                             NeighborhoodCode *codes, NeighborhoodKernel kernel = bestNeighborhoodKernel());
+
+    inline Surroundings decodeNeighborhood(NeighborhoodCode code) {
+        Surroundings sur;
+        for (unsigned i = 0; i < 4; ++i) sur.array[i] = (PieceType) ((code >> (3 * i)) & 7);
+        sur.array[4] = SELF;
+        for (unsigned i = 5; i < 9; ++i) sur.array[i] = (PieceType) ((code >> (3 * (i - 1))) & 7);
+        return sur;
+    }
+
+}
+
+
+#endif //PA5GAME_NEIGHBORHOODCODES_H
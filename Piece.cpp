@@ -1,20 +1,43 @@
 #include <sstream>
 #include "Piece.h"
+#include "Agent.h"
+#include "Resource.h"
 
 namespace Gaming {
 
-    unsigned int Piece::__idGen = 1000;
+    std::atomic<unsigned int> Piece::__idGen(1000);
 
-    Piece::Piece(const Game &g, const Position &p) : __game(g), __position(p)
+    // note: constant-initialized, so it is in place before any static Game is built
+    const InteractionTable Piece::DEFAULT_INTERACTIONS = {{
+            //  SIMPLE          STRATEGIC       FOOD              ADVANTAGE
+            {{ &Agent::fight,  &Agent::fight,  &Agent::consume,  &Agent::consume }},  // SIMPLE
+            {{ &Agent::fight,  &Agent::fight,  &Agent::consume,  &Agent::consume }},  // STRATEGIC
+            {{ &Resource::stay, &Resource::stay, &Resource::stay, &Resource::stay }}, // FOOD
+            {{ &Resource::stay, &Resource::stay, &Resource::stay, &Resource::stay }}  // ADVANTAGE
+    }};
+
+    Piece::Piece(const Game &g, const Position &p, bool mobile) : __mobile(mobile), __game(g), __position(p)
     {
         __finished = false;
         __turned = false;
+        __tag = EMPTY;
+        __slot = 0;
         __id = __idGen++;
     }
 
+    Piece::Piece(const Game &g, const Piece &another) :
+            __finished(another.__finished), __turned(another.__turned), __tag(another.__tag), __slot(another.__slot),
+            __mobile(another.__mobile), __position(another.__position), __game(g), __id(another.__id)
+    { }
+
     Piece::~Piece()
     { }
 
+    Piece *Piece::clone(const Game &, PieceArena &) const
+    {
+        throw UnsupportedEx("piece can't be cloned");
+    }
+
     std::ostream &operator<<(std::ostream &os, const Piece &piece)
     {
         piece.print(os);
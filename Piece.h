@@ -6,36 +6,57 @@
 #define PA5GAME_GAMEUNIT_H
 
 #include <string>
+#include <atomic>
 
 #include "Game.h"
 
 namespace Gaming {
 
     class Resource;
+    class SoAGrid;
+    class Piece;
 
     class Piece {
+        friend class SoAGrid;
+        friend class Game; // note: restores ids from snapshots
+        friend class TimingWheel;
+        friend class Agent;     // note: the only two bases of pieces, see isMobile
+        friend class Resource;
 
     private:
-        static unsigned int __idGen;
+        static std::atomic<unsigned int> __idGen; // note: games may be built on several threads
 
         bool __finished;
         bool __turned;
+        PieceType __tag; // note: the type of a built-in piece (see visitPiece), EMPTY for any other piece
+        unsigned int __slot; // note: where the piece is in the live list (agents) or timing wheel (resources) of its Game
+        bool __mobile;
 
         Position __position;
 
+        // note: private, so that every piece is an Agent (mobile) or a Resource (immobile)
+        Piece(const Game &g, const Position &p, bool mobile);
+        Piece(const Game &g, const Piece &another); // note: the same piece (id and all) in another Game
+
     protected:
         const Game &__game; // note: a reference to the Game object
         unsigned int __id;
 
         virtual void print(std::ostream &os) const = 0;
 
+        void setTag(PieceType tag) { __tag = tag; } // note: only for the built-in final classes
+
         void finish() { __finished = true; }
         bool isFinished() const { return __finished; }
 
     public:
-        Piece(const Game &g, const Position &p);
         virtual ~Piece();
 
+        virtual Piece *clone(const Game &g, PieceArena &arena) const; // note: a copy for another Game, throws UnsupportedEx unless overridden
+
+        unsigned int getId() const { return __id; }
+        PieceType getTag() const { return __tag; }
+
         const Position getPosition() const { return __position; }
         void setPosition(const Position &p) { __position = p; }
 
@@ -46,9 +67,18 @@ namespace Gaming {
         virtual bool isViable() const = 0;
         virtual PieceType getType() const = 0;
 
+        // mobile pieces take turns; immobile ones only age, and the Game doesn't schedule them at all
+        // note: fixed by the base, every Agent is mobile and every Resource immobile; the board relies
+        // on it to treat a piece as the one or the other, and no other class can derive from Piece
+        bool isMobile() const { return __mobile; }
+
         virtual ActionType takeTurn(const Surroundings &surr) const = 0; // note: doesn't actually change the object
 
-        virtual Piece &operator*(Piece &other) = 0;
+        // the interactions every Game starts with (see Game::setInteraction)
+        static const InteractionTable DEFAULT_INTERACTIONS;
+
+        // note: as set up in the Game of the piece
+        Piece &operator*(Piece &other) { return __game.getInteraction(getType(), other.getType())(*this, other); }
         virtual Piece &interact(Agent *) = 0;
         virtual Piece &interact(Resource *) = 0;
 
@@ -0,0 +1,78 @@
+#include <new>
+#include "PieceArena.h"
+
+namespace Gaming {
+
+    // every block starts with a header holding its size class (NUM_CLASSES for heap blocks)
+    static const std::size_t HEADER = 16;
+
+    PieceArena::PieceArena() : __cursor(nullptr), __limit(nullptr), __nextSlab(MIN_SLAB)
+    {
+        for (std::size_t c = 0; c < NUM_CLASSES; ++c) __free[c] = nullptr;
+    }
+
+    PieceArena::~PieceArena()
+    {
+        for (auto it = __slabs.begin(); it != __slabs.end(); ++it)
+            ::operator delete(*it);
+    }
+
+    void PieceArena::__grow(std::size_t bytes)
+    {
+        std::size_t size = (bytes > __nextSlab) ? bytes : __nextSlab;
+        __cursor = static_cast<char *>(::operator new(size));
+        __limit = __cursor + size;
+        __slabs.push_back(__cursor);
+        __nextSlab = size * 2;
+    }
+
+    void PieceArena::reserve(std::size_t numObjects, std::size_t size)
+    {
+        std::size_t bytes = numObjects * (HEADER + (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+        if ((std::size_t) (__limit - __cursor) < bytes) __grow(bytes);
+    }
+
+    void *PieceArena::allocate(std::size_t size)
+    {
+        std::size_t c = (size + ALIGNMENT - 1) / ALIGNMENT - 1;
+        if (size == 0) c = 0;
+
+        char *block;
+        if (c >= NUM_CLASSES)
+        {
+            block = static_cast<char *>(::operator new(HEADER + size));
+            c = NUM_CLASSES;
+        }
+        else if (__free[c])
+        {
+            block = static_cast<char *>(__free[c]) - HEADER;
+            __free[c] = *static_cast<void **>(__free[c]);
+        }
+        else
+        {
+            std::size_t bytes = HEADER + (c + 1) * ALIGNMENT;
+            if ((std::size_t) (__limit - __cursor) < bytes) __grow(bytes);
+            block = __cursor;
+            __cursor += bytes;
+        }
+
+        *reinterpret_cast<std::size_t *>(block) = c;
+        return block + HEADER;
+    }
+
+    void PieceArena::release(void *p)
+    {
+        if (!p) return;
+
+        char *block = static_cast<char *>(p) - HEADER;
+        std::size_t c = *reinterpret_cast<std::size_t *>(block);
+        if (c == NUM_CLASSES)
+        {
+            ::operator delete(block);
+            return;
+        }
+        *static_cast<void **>(p) = __free[c];
+        __free[c] = p;
+    }
+
+}
@@ -0,0 +1,66 @@
+//
+// Slab allocator for the pieces of a Game
+//
+
+#ifndef PA5GAME_PIECEARENA_H
+#define PA5GAME_PIECEARENA_H
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <new>
+
+namespace Gaming {
+
+    // Hands out memory for Piece objects (and anything else a Game owns) from a
+    // few large slabs. Freed blocks go on a free list per 16-byte size class and
+    // are reused by the next allocation of that class; the slabs themselves are
+    // only given back when the arena goes away.
+    class PieceArena {
+        static const std::size_t ALIGNMENT = 16;
+        static const std::size_t NUM_CLASSES = 16;  // blocks of up to 256 bytes, larger ones go to the heap
+        static const std::size_t MIN_SLAB = 4096;
+
+        std::vector<char *> __slabs;
+        char *__cursor, *__limit;
+        std::size_t __nextSlab;     // slabs grow geometrically
+        void *__free[NUM_CLASSES];
+
+        void __grow(std::size_t bytes);
+
+    public:
+        PieceArena();
+        PieceArena(const PieceArena &another) = delete;
+        PieceArena &operator=(const PieceArena &other) = delete;
+        ~PieceArena();
+
+        // make room for numObjects allocations of up to size bytes in a single slab
+        void reserve(std::size_t numObjects, std::size_t size);
+
+        void *allocate(std::size_t size);
+        void release(void *p);
+
+        unsigned getNumSlabs() const { return (unsigned) __slabs.size(); }
+
+        template <class T, class... Args>
+        T *make(Args&&... args) {
+            void *p = allocate(sizeof(T));
+            try {
+                return new (p) T(std::forward<Args>(args)...);
+            } catch (...) {
+                release(p);
+                throw;
+            }
+        }
+
+        template <class T>
+        void destroy(T *object) {
+            object->~T();
+            release(object);
+        }
+    };
+
+}
+
+
+#endif //PA5GAME_PIECEARENA_H
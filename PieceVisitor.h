@@ -0,0 +1,35 @@
+//
+// Static dispatch over the built-in pieces
+//
+
+#ifndef PA5GAME_PIECEVISITOR_H
+#define PA5GAME_PIECEVISITOR_H
+
+#include "Simple.h"
+#include "Strategic.h"
+#include "Food.h"
+#include "Advantage.h"
+
+namespace Gaming {
+
+    // Calls visitor with the piece as its built-in class (Simple, Strategic, Food or Advantage), so that
+    // what the visitor calls on it is bound at compile time and can be inlined. Any other piece is passed
+    // on as a Piece and goes through its virtual functions.
+    // note: the visitor needs an operator() for Piece & and either a template or an overload per class
+    template <class Visitor>
+    auto visitPiece(Piece &piece, Visitor &&visitor) -> decltype(visitor(piece))
+    {
+        switch (piece.getTag())
+        {
+            case SIMPLE:    return visitor(static_cast<Simple &>(piece));
+            case STRATEGIC: return visitor(static_cast<Strategic &>(piece));
+            case FOOD:      return visitor(static_cast<Food &>(piece));
+            case ADVANTAGE: return visitor(static_cast<Advantage &>(piece));
+            default:        return visitor(piece);
+        }
+    }
+
+}
+
+
+#endif //PA5GAME_PIECEVISITOR_H
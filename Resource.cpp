@@ -4,16 +4,27 @@ namespace Gaming {
 
     const double Resource::RESOURCE_SPOIL_FACTOR = 1.2;
 
-    Resource::Resource(const Game &g, const Position &p, double capacity) : Piece(g, p), __capacity(capacity)
+    Resource::Resource(const Game &g, const Position &p, double capacity) :
+            Piece(g, p, false), __born(g.__ticks), __expiry(0), __capacity(capacity)
+    { }
+
+    Resource::Resource(const Game &g, const Resource &another) :
+            Piece(g, another), __born(another.__born), __expiry(another.__expiry), __capacity(another.__capacity)
     { }
 
     Resource::~Resource()
     { }
 
+    double Resource::__rawCapacity() const
+    {
+        return __capacity - (__game.__ticks - __born) * RESOURCE_SPOIL_FACTOR;
+    }
+
     double Resource::consume()
     {
-        double ret = __capacity;
+        double ret = __rawCapacity();
         __capacity = -1;
+        __born = __game.__ticks;    // note: -1 until the resource is taken off the board
         finish();
         return ret;
     }
@@ -21,7 +32,8 @@ namespace Gaming {
     void Resource::age()
     {
         __capacity -= RESOURCE_SPOIL_FACTOR;
-        if (__capacity <= 0) finish();
+        if (__rawCapacity() <= 0) finish();
+        __game.__respoil(this);
     }
 
     ActionType Resource::takeTurn(const Surroundings &s) const
@@ -29,8 +41,10 @@ namespace Gaming {
         return ActionType::STAY;
     }
 
-    Piece &Resource::operator*(Piece &other)
-    { }
+    Piece &Resource::stay(Piece &resource, Piece &other)
+    {
+        return resource;
+    }
 
     Piece &Resource::interact(Agent *)
     {
@@ -11,27 +11,39 @@
 namespace Gaming {
 
     class Resource : public Piece {
+        friend class SoAGrid;
+        friend class Game;
+
+        unsigned int __born;    // note: the tick of the game __capacity is as of
+        unsigned int __expiry;  // note: the tick the resource has spoiled by, where it waits in the timing wheel
 
     protected:
         double __capacity;
-        
+
+        // the raw capacity now: resources spoil by RESOURCE_SPOIL_FACTOR as every round of the game
+        // starts, counted from birth rather than applied to each resource in turn
+        double __rawCapacity() const;
+
     public:
         static const double RESOURCE_SPOIL_FACTOR;
 
         Resource(const Game &g, const Position &p, double capacity);
+        Resource(const Game &g, const Resource &another);
         ~Resource();
 
-        virtual double getCapacity() const { return __capacity; }
+        virtual double getCapacity() const { return __rawCapacity(); }
         virtual double consume();
 
+        // note: spoils the resource once more, on top of the rounds of its game, and moves it up
+        // the timing wheel of the game if it is on the board
         void age() override final;
 
-        bool isViable() const override final { return !isFinished() && __capacity > 0.0; }
+        bool isViable() const override final { return !isFinished() && __rawCapacity() > 0.0; }
 
         ActionType takeTurn(const Surroundings &s) const override;
 
         // note: these won't be called while resources don't move
-        Piece &operator*(Piece &other) override final;
+        static Piece &stay(Piece &resource, Piece &other);
         Piece &interact(Agent *) override final;
         Piece &interact(Resource *) override final; // note: no interaction between resources
     };
@@ -10,20 +10,25 @@
 
 namespace Gaming {
 
-    class Simple : public Agent {
-    private:
-        static const char SIMPLE_ID;
-
+    class Simple final : public Agent {
     public:
+        static const char SIMPLE_ID; // note: the letter the piece prints as
+
         Simple(const Game &g, const Position &p, double energy);
+        Simple(const Game &g, const Simple &another);
         ~Simple();
 
+        Piece *clone(const Game &g, PieceArena &arena) const override { return arena.make<Simple>(g, *this); }
+
         PieceType getType() const override { return PieceType::SIMPLE; }
 
         void print(std::ostream &os) const override;
 
         ActionType takeTurn(const Surroundings &s) const override;
 
+        // the Simple agent's behavior, shared with the SoAGrid backend
+        static ActionType chooseAction(const Surroundings &s);
+
     };
 }
 
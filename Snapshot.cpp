@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PA5GAME_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Snapshot.h"
+#include "Exceptions.h"
+
+namespace Gaming {
+
+    const char Snapshot::MAGIC[4] = { 'P', 'A', '4', 'S' };
+
+    Snapshot::Snapshot(const std::string &path) :
+            __path(path), __data(nullptr), __size(0)
+    {
+#ifdef PA5GAME_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw SnapshotEx(path, "cannot open");
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw SnapshotEx(path, "cannot stat");
+        }
+        __size = (std::size_t) st.st_size;
+        if (__size >= HEADER_SIZE)
+        {
+            void *p = ::mmap(nullptr, __size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw SnapshotEx(path, "cannot map");
+            }
+            __data = (const unsigned char *) p;
+        }
+        ::close(fd); // note: the mapping stays valid
+#else
+        std::ifstream is(path, std::ios::binary);
+        if (!is) throw SnapshotEx(path, "cannot open");
+        __buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        __size = __buffer.size();
+        __data = __buffer.data();
+#endif
+
+        const char *reason = nullptr;
+        if (__size < HEADER_SIZE) reason = "truncated header";
+        else if (std::memcmp(__data, MAGIC, sizeof(MAGIC)) != 0) reason = "not a snapshot";
+        else if (load32(__data + 4) != VERSION) reason = "unsupported version";
+        else if (__size < HEADER_SIZE + padded(load32(__data + 32)) + (std::size_t) getNumRecords() * RECORD_SIZE)
+            reason = "truncated records";
+        else if ((std::uint64_t) getWidth() * getHeight() < getNumRecords()) reason = "more records than cells";
+
+        if (reason)
+        {
+            __unmap();
+            throw SnapshotEx(path, reason);
+        }
+    }
+
+    Snapshot::~Snapshot()
+    {
+        __unmap();
+    }
+
+    void Snapshot::__unmap()
+    {
+#ifdef PA5GAME_MMAP
+        if (__data) ::munmap((void *) __data, __size);
+#endif
+        __data = nullptr;
+    }
+
+    void Snapshot::write(const std::string &path, const std::vector<unsigned char> &bytes)
+    {
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream os(temp, std::ios::binary | std::ios::trunc);
+            if (!os) throw SnapshotEx(temp, "cannot create");
+            os.write((const char *) bytes.data(), bytes.size());
+            if (!os.flush()) throw SnapshotEx(temp, "cannot write");
+        }
+        if (std::rename(temp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp.c_str());
+            throw SnapshotEx(path, "cannot replace");
+        }
+    }
+
+}
@@ -0,0 +1,115 @@
+//
+// Binary snapshot files of a Game
+//
+
+#ifndef PA5GAME_SNAPSHOT_H
+#define PA5GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Gaming {
+
+    // Layout of a snapshot (version 1), all integers little-endian, doubles as IEEE-754 bit patterns:
+    //
+    //   offset  size
+    //   0       4     magic "PA4S"
+    //   4       4     version
+    //   8       4     width
+    //   12      4     height
+    //   16      4     round
+    //   20      4     number of piece records
+    //   24      1     status
+    //   25      1     backend
+    //   26      1     turn order
+    //   27      1     update (0 in files from before synchronous rounds, i.e. sequential)
+    //   28      4     seed of the random source
+    //   32      4     size of the random source state
+    //   36      1     layout of the object grid (0 in files from before layouts, i.e. row-major)
+    //   37      27    reserved (0)
+    //   64            random source state (text), padded with zeros to a multiple of 8
+    //   ...           piece records, RECORD_SIZE bytes each, in grid order:
+    //
+    //   0       4     cell index (row-major)
+    //   4       4     piece id
+    //   8       1     PieceType
+    //   9       1     strategy tag (Strategic only)
+    //   10      6     reserved (0)
+    //   16      8     energy (agents) or capacity (resources)
+    //   24      8     strategy parameter (e.g. the energy an aggressive strategy was made for)
+    //
+    // A loaded snapshot is read straight out of a read-only mapping of the file.
+    class Snapshot {
+        std::string __path;
+        const unsigned char *__data;
+        std::size_t __size;
+        std::vector<unsigned char> __buffer;    // note: only used where files can't be mapped
+
+        void __unmap();
+
+    public:
+        static const char MAGIC[4];
+        static const std::uint32_t VERSION = 1;
+        static const std::size_t HEADER_SIZE = 64;
+        static const std::size_t RECORD_SIZE = 32;
+
+        enum StrategyTag { NO_STRATEGY = 0, DEFAULT_STRATEGY, AGGRESSIVE_STRATEGY };
+
+        // map the file and check its header, throws SnapshotEx
+        explicit Snapshot(const std::string &path);
+        Snapshot(const Snapshot &another) = delete;
+        Snapshot &operator=(const Snapshot &other) = delete;
+        ~Snapshot();
+
+        const unsigned char *data() const { return __data; }
+        std::size_t size() const { return __size; }
+
+        std::uint32_t getWidth() const { return load32(__data + 8); }
+        std::uint32_t getHeight() const { return load32(__data + 12); }
+        std::uint32_t getRound() const { return load32(__data + 16); }
+        std::uint32_t getNumRecords() const { return load32(__data + 20); }
+        unsigned getStatus() const { return __data[24]; }
+        unsigned getBackend() const { return __data[25]; }
+        unsigned getTurnOrder() const { return __data[26]; }
+        unsigned getUpdate() const { return __data[27]; }
+        unsigned getLayout() const { return __data[36]; }
+        std::uint32_t getSeed() const { return load32(__data + 28); }
+        std::string getRandomState() const {
+            return std::string((const char *) __data + HEADER_SIZE, load32(__data + 32));
+        }
+        const unsigned char *getRecord(unsigned i) const {
+            return __data + HEADER_SIZE + padded(load32(__data + 32)) + i * RECORD_SIZE;
+        }
+
+        // write a snapshot atomically: into a temporary file next to path, then renamed over it
+        static void write(const std::string &path, const std::vector<unsigned char> &bytes);
+
+        static std::size_t padded(std::size_t size) { return (size + 7) & ~(std::size_t) 7; }
+
+        static std::uint32_t load32(const unsigned char *p) {
+            return (std::uint32_t) p[0] | (std::uint32_t) p[1] << 8 | (std::uint32_t) p[2] << 16 | (std::uint32_t) p[3] << 24;
+        }
+        static double loadDouble(const unsigned char *p) {
+            std::uint64_t bits = (std::uint64_t) load32(p) | (std::uint64_t) load32(p + 4) << 32;
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+        static void store32(unsigned char *p, std::uint32_t v) {
+            p[0] = (unsigned char) v; p[1] = (unsigned char) (v >> 8);
+            p[2] = (unsigned char) (v >> 16); p[3] = (unsigned char) (v >> 24);
+        }
+        static void storeDouble(unsigned char *p, double d) {
+            std::uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(d));
+            store32(p, (std::uint32_t) bits);
+            store32(p + 4, (std::uint32_t) (bits >> 32));
+        }
+    };
+
+}
+
+
+#endif //PA5GAME_SNAPSHOT_H
@@ -0,0 +1,292 @@
+#include <algorithm>
+
+#include "SoAGrid.h"
+#include "Piece.h"
+#include "Agent.h"
+#include "Resource.h"
+#include "Simple.h"
+#include "Strategic.h"
+#include "Advantage.h"
+
+namespace Gaming {
+
+    SoAGrid::SoAGrid(unsigned width, unsigned height) :
+            __width(width), __height(height),
+            __type(width * height, EMPTY),
+            __energy(width * height, 0.0),
+            __born(width * height, 0),
+            __id(width * height, 0),
+            __turned(width * height, 0),
+            __finished(width * height, 0),
+            __strategy(width * height, nullptr),
+            __padded((width + 2) * (height + 2), INACCESSIBLE),
+            __code(width * height, 0),
+            __dirty(width * height, 0),
+            __ticks(0)
+    { }
+
+    void SoAGrid::__clear(unsigned index)
+    {
+        __type[index] = EMPTY;
+        __energy[index] = 0.0;
+        __born[index] = 0;
+        __id[index] = 0;
+        __turned[index] = 0;
+        __finished[index] = 0;
+        __strategy[index] = nullptr;
+    }
+
+    void SoAGrid::__swap(unsigned a, unsigned b)
+    {
+        std::swap(__type[a], __type[b]);
+        std::swap(__energy[a], __energy[b]);
+        std::swap(__born[a], __born[b]);
+        std::swap(__id[a], __id[b]);
+        std::swap(__turned[a], __turned[b]);
+        std::swap(__finished[a], __finished[b]);
+        std::swap(__strategy[a], __strategy[b]);
+    }
+
+    // the energy of an agent, or the raw capacity of a resource now
+    double SoAGrid::__value(unsigned index) const
+    {
+        if (__type[index] == FOOD || __type[index] == ADVANTAGE)
+            return __energy[index] - (__ticks - __born[index]) * Resource::RESOURCE_SPOIL_FACTOR;
+        return __energy[index];
+    }
+
+    bool SoAGrid::__isViable(unsigned index) const
+    {
+        return !__finished[index] && __value(index) > 0.0;
+    }
+
+    void SoAGrid::__encode()
+    {
+        for (unsigned x = 0; x < __height; ++x)
+            std::copy(__type.begin() + x * __width, __type.begin() + (x + 1) * __width,
+                      __padded.begin() + (x + 1) * (__width + 2) + 1);
+        encodeNeighborhoods(__padded.data(), __width, __height, __code.data());
+        std::fill(__dirty.begin(), __dirty.end(), 0);
+    }
+
+    void SoAGrid::__moved(unsigned a, unsigned b)
+    {
+        const unsigned cells[2] = { a, b };
+        for (unsigned c = 0; c < 2; ++c)
+        {
+            unsigned x = cells[c] / __width, y = cells[c] % __width;
+            __padded[(x + 1) * (__width + 2) + y + 1] = __type[cells[c]];
+            for (unsigned nx = x ? x - 1 : 0; nx <= x + 1 && nx < __height; ++nx)
+                for (unsigned ny = y ? y - 1 : 0; ny <= y + 1 && ny < __width; ++ny)
+                    __dirty[ny + nx * __width] = 1;
+        }
+    }
+
+    NeighborhoodCode SoAGrid::__neighborhood(unsigned index)
+    {
+        if (__dirty[index])
+        {
+            unsigned x = index / __width, y = index % __width;
+            __code[index] = encodeNeighborhood(&__padded[(x + 1) * (__width + 2) + y + 1], __width + 2);
+            __dirty[index] = 0;
+        }
+        return __code[index];
+    }
+
+    ActionType SoAGrid::__takeTurn(unsigned index, Random &rng)
+    {
+        if (__type[index] != SIMPLE && __type[index] != STRATEGIC) return STAY;
+
+        Surroundings surr = decodeNeighborhood(__neighborhood(index));
+        surr.rng = &rng;
+        return (__type[index] == SIMPLE) ? Simple::chooseAction(surr) : (*__strategy[index])(surr);
+    }
+
+    void SoAGrid::__interact(unsigned agent, unsigned other)
+    {
+        switch (__type[other])
+        {
+            case FOOD:
+            case ADVANTAGE:
+            {
+                double capacity = __value(other);
+                if (__type[other] == ADVANTAGE) capacity *= Advantage::ADVANTAGE_MULT_FACTOR;
+                __energy[agent] += capacity;
+                __energy[other] = -1;
+                __born[other] = __ticks;
+                __finished[other] = 1;
+                break;
+            }
+            case SIMPLE:
+            case STRATEGIC:
+                if (__energy[agent] == __energy[other])
+                {
+                    __finished[agent] = 1;
+                    __finished[other] = 1;
+                }
+                else if (__energy[agent] > __energy[other])
+                {
+                    __energy[agent] -= __energy[other];
+                    __finished[other] = 1;
+                }
+                else
+                {
+                    __energy[other] -= __energy[agent];
+                    __finished[agent] = 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void SoAGrid::place(unsigned index, const Piece *piece)
+    {
+        __clear(index);
+        if (!piece) return;
+
+        PieceType type = piece->getType();
+        __type[index] = (unsigned char) type;
+        __id[index] = piece->__id;
+        __turned[index] = piece->__turned;
+        __finished[index] = piece->__finished;
+        switch (type)
+        {
+            case STRATEGIC:
+                __strategy[index] = static_cast<const Strategic *>(piece)->__strategy;
+                // fall through
+            case SIMPLE:
+                __energy[index] = static_cast<const Agent *>(piece)->__energy;
+                break;
+            case FOOD:
+            case ADVANTAGE:
+                __energy[index] = static_cast<const Resource *>(piece)->__capacity;
+                __born[index] = static_cast<const Resource *>(piece)->__born;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void SoAGrid::load(const std::vector<Piece *> &grid)
+    {
+        for (unsigned i = 0; i < grid.size(); ++i)
+            place(i, grid[i]);
+    }
+
+    void SoAGrid::store(const std::vector<Piece *> &grid) const
+    {
+        for (unsigned i = 0; i < grid.size(); ++i)
+        {
+            Piece *piece = grid[i];
+            if (!piece) continue;
+
+            piece->setPosition(Position(i / __width, i % __width));
+            piece->__turned = __turned[i] != 0;
+            piece->__finished = __finished[i] != 0;
+            switch (__type[i])
+            {
+                case SIMPLE:
+                case STRATEGIC:
+                    static_cast<Agent *>(piece)->__energy = __energy[i];
+                    break;
+                case FOOD:
+                case ADVANTAGE:
+                    static_cast<Resource *>(piece)->__capacity = __energy[i];
+                    static_cast<Resource *>(piece)->__born = __born[i];
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    const Surroundings SoAGrid::getSurroundings(const Position &pos) const
+    {
+        Surroundings sur;
+        for (int row = -1; row <= 1; ++row)
+        {
+            for (int col = -1; col <= 1; ++col)
+            {
+                unsigned x = pos.x + row, y = pos.y + col; // note: wraps around below zero
+                sur.array[col + 1 + ((row + 1) * 3)] =
+                        (x < __height && y < __width) ? (PieceType) __type[y + x * __width] : INACCESSIBLE;
+            }
+        }
+        sur.array[4] = SELF;
+
+        return sur;
+    }
+
+    void SoAGrid::round(std::vector<Piece *> &grid, Random &rng, std::vector<Piece *> &removed,
+                        std::vector<Event> *events, unsigned roundNo)
+    {
+        __ticks = roundNo + 1;
+        std::fill(__turned.begin(), __turned.end(), 0);
+        __encode();
+
+        // Take turns in grid order; a piece carried forward by a move keeps its turned flag
+        // note: the resources take no turns, they spoil by themselves
+        for (unsigned i = 0; i < __type.size(); ++i)
+        {
+            if ((__type[i] != SIMPLE && __type[i] != STRATEGIC) || __turned[i]) continue;
+
+            __turned[i] = 1;
+            __energy[i] -= Agent::AGENT_FATIGUE_RATE;
+
+            ActionType ac = __takeTurn(i, rng);
+            if (ac == STAY) continue;
+
+            unsigned x = i / __width, y = i % __width;
+            switch (ac)
+            {
+                case E: y++; break;
+                case NE: y++; x--; break;
+                case N: x--; break;
+                case NW: y--; x--; break;
+                case W: y--; break;
+                case SW: y--; x++; break;
+                case S: x++; break;
+                case SE: x++; y++; break;
+                default: break;
+            }
+            if (x >= __height || y >= __width) continue; // illegal move, stay in place
+
+            unsigned j = y + x * __width;
+            Position from(i / __width, i % __width), to(x, y);
+            if (__type[j] != EMPTY)
+            {
+                double value0 = std::max(__energy[i], 0.0), other0 = std::max(__value(j), 0.0);
+                __interact(i, j);
+                if (events)
+                {
+                    Event::Kind kind = (__type[j] == SIMPLE || __type[j] == STRATEGIC) ? Event::FIGHT : Event::CONSUME;
+                    events->push_back(Event{ roundNo, kind, __id[i], __id[j], from, to,
+                                             std::max(__energy[i], 0.0) - value0, std::max(__value(j), 0.0) - other0 });
+                }
+                if (__finished[i]) continue;
+            }
+            if (events) events->push_back(Event{ roundNo, Event::MOVE, __id[i], 0, from, to, 0, 0 });
+            __swap(i, j);
+            __moved(i, j);
+            std::swap(grid[i], grid[j]);
+        }
+
+        // Remove the pieces which didn't make it
+        for (unsigned i = 0; i < __type.size(); ++i)
+        {
+            if (__type[i] != EMPTY && !__isViable(i))
+            {
+                if (events)
+                {
+                    Position pos(i / __width, i % __width);
+                    events->push_back(Event{ roundNo, Event::REMOVE, __id[i], 0, pos, pos, -std::max(__value(i), 0.0), 0 });
+                }
+                removed.push_back(grid[i]);
+                grid[i] = nullptr;
+                __clear(i);
+            }
+        }
+    }
+
+}
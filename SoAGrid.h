@@ -0,0 +1,87 @@
+//
+// Structure-of-arrays grid backend for Game
+//
+
+#ifndef PA5GAME_SOAGRID_H
+#define PA5GAME_SOAGRID_H
+
+#include <vector>
+
+#include "Gaming.h"
+#include "NeighborhoodCodes.h"
+#include "EventLog.h"
+
+namespace Gaming {
+
+    class Piece;
+    class Strategy;
+
+    // Keeps the per-cell state of a Game in contiguous parallel planes, so that
+    // a round walks flat arrays instead of chasing Piece pointers across the heap.
+    //
+    // The Piece objects of the Game stay alive as handles: the pointer plane
+    // (the Game's own grid) is moved along with the cells, but it is only
+    // dereferenced when a piece dies or when the objects are synchronized with
+    // store().
+    class SoAGrid {
+        unsigned __width, __height;
+
+        std::vector<unsigned char> __type;          // PieceType of the cell, EMPTY if vacant
+        std::vector<double> __energy;               // agent energy or (raw) resource capacity as of __born
+        std::vector<unsigned int> __born;           // the tick of the game a resource capacity is as of
+        std::vector<unsigned int> __id;             // id of the piece in the cell
+        std::vector<unsigned char> __turned;        // piece has had its turn this round
+        std::vector<unsigned char> __finished;      // piece has been consumed/defeated/spoiled
+        std::vector<const Strategy *> __strategy;   // not owned, only set for STRATEGIC cells
+
+        // neighborhood codes of the cells, encoded in bulk at the start of a round;
+        // a move marks the 3x3 blocks around its two cells dirty, to be re-encoded on their turn
+        std::vector<unsigned char> __padded;        // the type plane inside an INACCESSIBLE border
+        std::vector<NeighborhoodCode> __code;
+        std::vector<unsigned char> __dirty;
+
+        unsigned __ticks;                           // of the game, see Resource::__rawCapacity
+
+        void __clear(unsigned index);
+        double __value(unsigned index) const;
+        void __swap(unsigned a, unsigned b);
+        bool __isViable(unsigned index) const;
+        ActionType __takeTurn(unsigned index, Random &rng);
+        void __interact(unsigned agent, unsigned other);
+        void __encode();
+        void __moved(unsigned a, unsigned b);
+        NeighborhoodCode __neighborhood(unsigned index);
+
+    public:
+        SoAGrid(unsigned width, unsigned height);
+        SoAGrid(const SoAGrid &another) = delete;
+        SoAGrid &operator=(const SoAGrid &other) = delete;
+
+        unsigned getWidth() const { return __width; }
+        unsigned getHeight() const { return __height; }
+
+        PieceType getType(unsigned index) const { return (PieceType) __type[index]; }
+        double getEnergy(unsigned index) const { return __energy[index]; }
+        unsigned int getId(unsigned index) const { return __id[index]; }
+
+        // copy the state of a piece (or nullptr for an empty cell) into the planes
+        void place(unsigned index, const Piece *piece);
+        void load(const std::vector<Piece *> &grid);
+
+        // write the plane state back into the piece objects of the grid
+        void store(const std::vector<Piece *> &grid) const;
+
+        const Surroundings getSurroundings(const Position &pos) const;
+
+        // play a single round, keeping the pointer plane in step with the cells; the resources spoil as
+        // it starts, like those of the Game (which has started roundNo + 1 rounds by then);
+        // the pieces which did not survive it are taken off the grid and added to removed,
+        // and what happened is added to events (if not nullptr) as round roundNo
+        void round(std::vector<Piece *> &grid, Random &rng, std::vector<Piece *> &removed,
+                   std::vector<Event> *events = nullptr, unsigned roundNo = 0);
+    };
+
+}
+
+
+#endif //PA5GAME_SOAGRID_H
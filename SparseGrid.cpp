@@ -0,0 +1,63 @@
+#include <algorithm>
+
+#include "SparseGrid.h"
+
+namespace Gaming {
+
+    void SparseGrid::set(unsigned x, unsigned y, Piece *piece)
+    {
+        std::uint64_t key = __key(x, y);
+        auto it = __tiles.find(key);
+        if (it == __tiles.end())
+        {
+            if (!piece) return;
+            it = __tiles.insert(std::make_pair(key, Tile())).first;
+            std::fill(it->second.cells, it->second.cells + TILE * TILE, nullptr);
+            it->second.count = 0;
+        }
+
+        Tile &tile = it->second;
+        Piece *&cell = tile.cells[__cell(x, y)];
+        if (cell && !piece)
+        {
+            --__size;
+            if (--tile.count == 0)
+            {
+                __tiles.erase(it);
+                return;
+            }
+        }
+        else if (!cell && piece)
+        {
+            ++__size;
+            ++tile.count;
+        }
+        cell = piece;
+    }
+
+    void SparseGrid::collect(std::vector<Piece *> &pieces) const
+    {
+        // tiles sorted by row of tiles, then by column
+        std::vector<std::uint64_t> keys;
+        keys.reserve(__tiles.size());
+        for (auto it = __tiles.begin(); it != __tiles.end(); ++it) keys.push_back(it->first);
+        std::sort(keys.begin(), keys.end());
+
+        // a row of tiles at a time, every row of cells across all its tiles
+        for (std::size_t first = 0; first < keys.size(); )
+        {
+            std::size_t last = first;
+            while (last < keys.size() && (keys[last] >> 32) == (keys[first] >> 32)) ++last;
+
+            for (unsigned row = 0; row < TILE; ++row)
+                for (std::size_t k = first; k < last; ++k)
+                {
+                    const Tile &tile = __tiles.find(keys[k])->second;
+                    for (unsigned col = 0; col < TILE; ++col)
+                        if (tile.cells[row * TILE + col]) pieces.push_back(tile.cells[row * TILE + col]);
+                }
+            first = last;
+        }
+    }
+
+}
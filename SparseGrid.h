@@ -0,0 +1,65 @@
+//
+// Sparse grid backend for Game
+//
+
+#ifndef PA5GAME_SPARSEGRID_H
+#define PA5GAME_SPARSEGRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Gaming.h"
+
+namespace Gaming {
+
+    class Piece;
+
+    // Holds the pieces of a Game in TILE x TILE tiles, hashed by tile coordinates.
+    // Only tiles with a piece in them are kept, so memory follows the number of
+    // pieces rather than the size of the board; a tile is dropped when its last
+    // piece leaves.
+    class SparseGrid {
+    public:
+        static const unsigned TILE = 8;
+
+    private:
+        struct Tile {
+            Piece *cells[TILE * TILE];  // row-major within the tile, nullptr if vacant
+            unsigned count;
+        };
+
+        std::unordered_map<std::uint64_t, Tile> __tiles;
+        unsigned __size;
+
+        static std::uint64_t __key(unsigned x, unsigned y) {
+            return (std::uint64_t) (x / TILE) << 32 | (y / TILE);
+        }
+        static unsigned __cell(unsigned x, unsigned y) { return (x % TILE) * TILE + y % TILE; }
+
+    public:
+        SparseGrid() : __size(0) {}
+        SparseGrid(const SparseGrid &another) = delete;
+        SparseGrid &operator=(const SparseGrid &other) = delete;
+
+        unsigned size() const { return __size; }        // number of pieces
+        unsigned getNumTiles() const { return (unsigned) __tiles.size(); }
+
+        Piece *get(unsigned x, unsigned y) const {
+            auto it = __tiles.find(__key(x, y));
+            return (it == __tiles.end()) ? nullptr : it->second.cells[__cell(x, y)];
+        }
+
+        // nullptr vacates the cell
+        void set(unsigned x, unsigned y, Piece *piece);
+
+        // append the pieces in row-major order of their cells, as a dense grid would list them
+        void collect(std::vector<Piece *> &pieces) const;
+
+        void clear() { __tiles.clear(); __size = 0; }  // note: the pieces are not destroyed
+    };
+
+}
+
+
+#endif //PA5GAME_SPARSEGRID_H
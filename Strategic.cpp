@@ -7,30 +7,28 @@ namespace Gaming
 
     const char Strategic::STRATEGIC_ID = 'T';
 
-    Strategic::Strategic(const Game &g, const Position &p, double energy, Strategy *s)
+    Strategic::Strategic(const Game &g, const Position &p, double energy, Strategy *s, bool ownsStrategy)
             : Agent(g, p, energy)
     {
+        setTag(STRATEGIC);
         __strategy = s;
+        __ownsStrategy = ownsStrategy;
+    }
+
+    Strategic::Strategic(const Game &g, const Strategic &another) : Agent(g, another)
+    {
+        __strategy = another.__ownsStrategy ? another.__strategy->clone() : another.__strategy;
+        __ownsStrategy = another.__ownsStrategy;
     }
 
     Strategic::~Strategic()
     {
-        delete __strategy;
+        if (__ownsStrategy) delete __strategy;
     }
 
     void Strategic::print(std::ostream &os) const
     {
-        std::string str;
-        str = std::to_string(__id);
-
-        std::stringstream ss;
-        ss << Strategic::STRATEGIC_ID;
-        ss << str;
-        std::getline(ss, str);
-        for (int i = 0; i < str.length(); ++i)
-        {
-            os << str[i];
-        }
+        os << Strategic::STRATEGIC_ID << __id;
     }
 
     ActionType Strategic::takeTurn(const Surroundings &s) const
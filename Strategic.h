@@ -12,16 +12,26 @@
 
 namespace Gaming {
 
-    class Strategic : public Agent {
-    private:
-        static const char STRATEGIC_ID;
+    class Strategic final : public Agent {
+        friend class SoAGrid;
 
+    private:
         Strategy *__strategy;
+        bool __ownsStrategy;
 
     public:
-        Strategic(const Game &g, const Position &p, double energy, Strategy *s = new DefaultAgentStrategy());
+        static const char STRATEGIC_ID; // note: the letter the piece prints as
+
+        // note: a strategy which is not owned (e.g. shared by many agents) is not deleted with the agent
+        Strategic(const Game &g, const Position &p, double energy, Strategy *s = new DefaultAgentStrategy(),
+                  bool ownsStrategy = true);
+        Strategic(const Game &g, const Strategic &another); // note: clones an owned strategy, shares any other
         ~Strategic();
 
+        Piece *clone(const Game &g, PieceArena &arena) const override { return arena.make<Strategic>(g, *this); }
+
+        const Strategy *getStrategy() const { return __strategy; }
+
         PieceType getType() const override { return PieceType::STRATEGIC; }
 
         void print(std::ostream &os) const override;
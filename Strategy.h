@@ -14,6 +14,14 @@ namespace Gaming {
         Strategy() {}
         virtual ~Strategy() {};
         virtual ActionType operator()(const Surroundings &s) const = 0;
+        // a strategy of the same kind and state, for a copy of a Game
+        // note: throws UnsupportedEx unless a strategy overrides it
+        virtual Strategy *clone() const { throw UnsupportedEx("strategy can't be cloned"); }
+
+        // true if operator() only STAYs when the types of the surroundings leave it no option, and
+        // then draws nothing from s.rng: the Game skips the agent's turns until its surroundings change
+        // note: false unless a strategy opts in, the agent ages all the same
+        virtual bool isTypeDriven() const { return false; }
     };
 
 }
@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+namespace Gaming {
+
+    ThreadPool::ThreadPool(unsigned numThreads) :
+            __ranges(numThreads ? numThreads : 1),
+            __stop(false), __generation(0), __busy(0), __task(nullptr)
+    {
+        for (unsigned i = 1; i < __ranges.size(); ++i)
+            __workers.push_back(std::thread(&ThreadPool::__work, this, i));
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(__mutex);
+            __stop = true;
+        }
+        __wake.notify_all();
+        for (auto it = __workers.begin(); it != __workers.end(); ++it)
+            it->join();
+    }
+
+    bool ThreadPool::__next(unsigned self, unsigned &task)
+    {
+        {
+            Range &own = __ranges[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end)
+            {
+                task = own.begin++;
+                return true;
+            }
+        }
+
+        // steal the back half of the first non-empty range after our own
+        for (unsigned i = 1; i < __ranges.size(); ++i)
+        {
+            Range &victim = __ranges[(self + i) % __ranges.size()];
+            unsigned begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin >= victim.end) continue;
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            task = begin;
+
+            Range &own = __ranges[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+
+        return false;
+    }
+
+    void ThreadPool::__drain(unsigned self)
+    {
+        unsigned task;
+        while (__next(self, task))
+            (*__task)(task);
+    }
+
+    void ThreadPool::__work(unsigned self)
+    {
+        unsigned seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(__mutex);
+                __wake.wait(lock, [&] { return __stop || __generation != seen; });
+                if (__stop) return;
+                seen = __generation;
+            }
+
+            __drain(self);
+
+            {
+                std::lock_guard<std::mutex> lock(__mutex);
+                if (--__busy == 0) __done.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::parallelFor(unsigned numTasks, const std::function<void(unsigned)> &task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(__mutex);
+            __task = &task;
+            const unsigned n = (unsigned) __ranges.size();
+            for (unsigned i = 0; i < n; ++i)
+            {
+                std::lock_guard<std::mutex> rangeLock(__ranges[i].mutex);
+                __ranges[i].begin = (unsigned) ((unsigned long long) numTasks * i / n);
+                __ranges[i].end = (unsigned) ((unsigned long long) numTasks * (i + 1) / n);
+            }
+            __busy = (unsigned) __workers.size();
+            ++__generation;
+        }
+        __wake.notify_all();
+
+        __drain(0);
+
+        std::unique_lock<std::mutex> lock(__mutex);
+        __done.wait(lock, [&] { return __busy == 0; });
+        __task = nullptr;
+    }
+
+}
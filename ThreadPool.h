@@ -0,0 +1,59 @@
+//
+// Fixed-size pool of worker threads
+//
+
+#ifndef PA5GAME_THREADPOOL_H
+#define PA5GAME_THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace Gaming {
+
+    // Runs batches of independent tasks on a fixed set of threads. The calling
+    // thread takes part in every batch, so a pool of size n starts n - 1 workers.
+    //
+    // A batch is dealt out as one contiguous range of task indices per thread.
+    // A thread works through its own range from the front and, once it runs
+    // dry, steals the back half of the range of another thread, so batches of
+    // uneven tasks (e.g. whole games) stay balanced.
+    class ThreadPool {
+        struct Range {
+            std::mutex mutex;
+            unsigned begin, end;
+        };
+
+        std::vector<std::thread> __workers;
+        std::vector<Range> __ranges;    // one per thread, the caller's first
+
+        std::mutex __mutex;
+        std::condition_variable __wake, __done;
+        bool __stop;
+        unsigned __generation;      // bumped for every batch
+        unsigned __busy;            // workers still inside the current batch
+
+        const std::function<void(unsigned)> *__task;
+
+        void __work(unsigned self);
+        void __drain(unsigned self);
+        bool __next(unsigned self, unsigned &task);
+
+    public:
+        explicit ThreadPool(unsigned numThreads);
+        ThreadPool(const ThreadPool &another) = delete;
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+        ~ThreadPool();
+
+        unsigned size() const { return (unsigned) __ranges.size(); }
+
+        // call task(i) for every i in [0, numTasks) and wait for all of them
+        void parallelFor(unsigned numTasks, const std::function<void(unsigned)> &task);
+    };
+
+}
+
+
+#endif //PA5GAME_THREADPOOL_H
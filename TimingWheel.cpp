@@ -0,0 +1,53 @@
+#include "TimingWheel.h"
+#include "Piece.h"
+
+namespace Gaming {
+
+    TimingWheel::TimingWheel(unsigned numBuckets) : __size(0)
+    {
+        unsigned n = 1;
+        while (n < numBuckets) n <<= 1;
+        __buckets.resize(n);
+        __mask = n - 1;
+    }
+
+    void TimingWheel::add(Piece *piece, unsigned tick)
+    {
+        std::vector<Entry> &bucket = __buckets[tick & __mask];
+        piece->__slot = (unsigned) bucket.size();
+        bucket.push_back(Entry{ piece, tick });
+        ++__size;
+    }
+
+    void TimingWheel::remove(Piece *piece, unsigned tick)
+    {
+        // swap-remove from the bucket
+        std::vector<Entry> &bucket = __buckets[tick & __mask];
+        Entry &last = bucket.back();
+        last.piece->__slot = piece->__slot;
+        bucket[piece->__slot] = last;
+        bucket.pop_back();
+        --__size;
+    }
+
+    void TimingWheel::collect(unsigned tick, std::vector<Piece *> &due) const
+    {
+        const std::vector<Entry> &bucket = __buckets[tick & __mask];
+        for (auto it = bucket.begin(); it != bucket.end(); ++it)
+            if (it->tick == tick) due.push_back(it->piece);
+    }
+
+    void TimingWheel::collectAll(std::vector<Piece *> &pieces) const
+    {
+        for (auto b = __buckets.begin(); b != __buckets.end(); ++b)
+            for (auto it = b->begin(); it != b->end(); ++it)
+                pieces.push_back(it->piece);
+    }
+
+    void TimingWheel::clear()
+    {
+        for (auto b = __buckets.begin(); b != __buckets.end(); ++b) b->clear();
+        __size = 0;
+    }
+
+}
@@ -0,0 +1,52 @@
+//
+// Pieces filed by the tick they expire at
+//
+
+#ifndef PA5GAME_TIMINGWHEEL_H
+#define PA5GAME_TIMINGWHEEL_H
+
+#include <cstddef>
+#include <vector>
+
+namespace Gaming {
+
+    class Piece;
+
+    // A ring of buckets, one per tick, a power of two of them: a piece expiring at
+    // tick t waits in bucket t mod the number of buckets. The pieces due at a tick
+    // are found without looking at the others, bar those a lap or more further off
+    // which share their bucket. A piece is taken out in constant time, through
+    // its slot (see Piece::__slot).
+    class TimingWheel {
+        struct Entry {
+            Piece *piece;
+            unsigned tick;
+        };
+
+        std::vector<std::vector<Entry> > __buckets;
+        unsigned __mask;
+        std::size_t __size;
+
+    public:
+        static const unsigned DEFAULT_BUCKETS = 64;
+
+        explicit TimingWheel(unsigned numBuckets = DEFAULT_BUCKETS);   // note: rounded up to a power of two
+
+        std::size_t size() const { return __size; }
+
+        void add(Piece *piece, unsigned tick);
+        void remove(Piece *piece, unsigned tick);   // note: the tick it was added with
+
+        // append the pieces expiring at tick, in no particular order
+        void collect(unsigned tick, std::vector<Piece *> &due) const;
+
+        // append every piece on the wheel, in no particular order
+        void collectAll(std::vector<Piece *> &pieces) const;
+
+        void clear();   // note: the pieces are not destroyed
+    };
+
+}
+
+
+#endif //PA5GAME_TIMINGWHEEL_H
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include "TurnScheduler.h"
+#include "Piece.h"
+
+namespace Gaming {
+
+    TurnScheduler::TurnScheduler(Order order) : __order(order)
+    { }
+
+    void TurnScheduler::schedule(const std::vector<Piece *> &grid, Random &rng)
+    {
+        __turns.clear(); // note: keeps the capacity
+        if (__turns.capacity() < grid.size()) __turns.reserve(grid.size());
+
+        for (auto it = grid.begin(); it != grid.end(); ++it)
+        {
+            if (*it) __turns.push_back(*it);
+        }
+
+        switch (__order)
+        {
+            case ID_ORDER:
+                std::sort(__turns.begin(), __turns.end(),
+                          [](const Piece *a, const Piece *b) { return a->getId() < b->getId(); });
+                break;
+            case SHUFFLED:
+                std::shuffle(__turns.begin(), __turns.end(), rng);
+                break;
+            default:
+                break;
+        }
+    }
+
+}
@@ -0,0 +1,49 @@
+//
+// Turn ordering for a round of a Game
+//
+
+#ifndef PA5GAME_TURNSCHEDULER_H
+#define PA5GAME_TURNSCHEDULER_H
+
+#include <vector>
+
+#include "Gaming.h"
+
+namespace Gaming {
+
+    class Piece;
+
+    // Lists the pieces of a grid in the order they take their turns in a round.
+    // The Game only hands it the mobile pieces (see Piece::isMobile): the immobile
+    // ones take no turns, they spoil on their own from the Game's timing wheel.
+    // The list lives in a flat buffer which is reused from round to round, so
+    // once it has grown to the number of pieces scheduling doesn't allocate.
+    class TurnScheduler {
+    public:
+        // GRID_ORDER: top-left row-wise bottom-right
+        // ID_ORDER: oldest piece first
+        // SHUFFLED: a random permutation, reproducible from the seed of the source
+        enum Order { GRID_ORDER, ID_ORDER, SHUFFLED };
+
+    private:
+        Order __order;
+        std::vector<Piece *> __turns;
+
+    public:
+        TurnScheduler(Order order = GRID_ORDER);
+
+        Order getOrder() const { return __order; }
+        void setOrder(Order order) { __order = order; }
+
+        // rebuild the turn list from the current grid, shuffling with rng if SHUFFLED
+        void schedule(const std::vector<Piece *> &grid, Random &rng);
+
+        std::vector<Piece *>::const_iterator begin() const { return __turns.begin(); }
+        std::vector<Piece *>::const_iterator end() const { return __turns.end(); }
+        unsigned int size() const { return (unsigned int) __turns.size(); }
+    };
+
+}
+
+
+#endif //PA5GAME_TURNSCHEDULER_H
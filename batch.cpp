@@ -0,0 +1,163 @@
+//
+// Batch driver: plays a parameter sweep of independent Games across all cores
+//
+// usage: pa4-batch [--sizes WxH,...] [--agent-factors n,...] [--resource-factors n,...]
+//                  [--seeds first-last] [--threads n] [--max-rounds n]
+//
+// Writes one CSV record per game to standard output, in sweep order.
+//
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "Game.h"
+#include "ThreadPool.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace Gaming;
+
+namespace {
+
+    struct Job {
+        unsigned width, height;
+        unsigned agentFactor, resourceFactor;
+        unsigned seed;
+    };
+
+    struct Record {
+        unsigned rounds;
+        unsigned numSimple, numStrategic, numResources;
+        double wallMs;
+    };
+
+    bool parseList(const std::string &arg, std::vector<unsigned> &values) {
+        std::stringstream ss(arg);
+        std::string item;
+        values.clear();
+        while (std::getline(ss, item, ',')) {
+            std::stringstream is(item);
+            unsigned value;
+            if (!(is >> value)) return false;
+            values.push_back(value);
+        }
+        return !values.empty();
+    }
+
+    bool parseSizes(const std::string &arg, std::vector<std::pair<unsigned, unsigned> > &sizes) {
+        std::stringstream ss(arg);
+        std::string item;
+        sizes.clear();
+        while (std::getline(ss, item, ',')) {
+            std::stringstream is(item);
+            unsigned width, height;
+            char x;
+            if (!(is >> width >> x >> height) || x != 'x') return false;
+            if (width < Game::MIN_WIDTH || height < Game::MIN_HEIGHT) return false;
+            sizes.push_back(std::make_pair(width, height));
+        }
+        return !sizes.empty();
+    }
+
+    bool parseRange(const std::string &arg, unsigned &first, unsigned &last) {
+        std::stringstream is(arg);
+        char dash;
+        if (!(is >> first)) return false;
+        if (!(is >> dash)) {
+            last = first;
+            return true;
+        }
+        return dash == '-' && (is >> last) && first <= last;
+    }
+
+    Record play(const Job &job, unsigned maxRounds) {
+        auto start = std::chrono::steady_clock::now();
+
+        Game g(job.width, job.height, true, job.seed);
+        g.populate(job.agentFactor, job.resourceFactor);
+        while (g.getStatus() != Game::OVER && (maxRounds == 0 || g.getRound() < maxRounds))
+            g.round();
+
+        Record record;
+        record.rounds = g.getRound();
+        record.numSimple = g.getNumSimple();
+        record.numStrategic = g.getNumStrategic();
+        record.numResources = g.getNumResources();
+        record.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return record;
+    }
+
+    void usage(const char *name) {
+        cerr << "usage: " << name << " [--sizes WxH,...] [--agent-factors n,...] [--resource-factors n,...]" << endl
+             << "       [--seeds first-last] [--threads n] [--max-rounds n]" << endl;
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+
+    std::vector<std::pair<unsigned, unsigned> > sizes(1, std::make_pair(20u, 20u));
+    std::vector<unsigned> agentFactors(1, 4), resourceFactors(1, 2);
+    unsigned firstSeed = 1, lastSeed = 100;
+    unsigned numThreads = std::thread::hardware_concurrency();
+    unsigned maxRounds = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option(argv[i]);
+        if (i + 1 == argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value(argv[++i]);
+        std::vector<unsigned> single;
+
+        bool ok;
+        if (option == "--sizes") ok = parseSizes(value, sizes);
+        else if (option == "--agent-factors") ok = parseList(value, agentFactors);
+        else if (option == "--resource-factors") ok = parseList(value, resourceFactors);
+        else if (option == "--seeds") ok = parseRange(value, firstSeed, lastSeed);
+        else if (option == "--threads") ok = parseList(value, single) && (numThreads = single[0]) > 0;
+        else if (option == "--max-rounds") ok = parseList(value, single) && ((maxRounds = single[0]), true);
+        else ok = false;
+
+        if (!ok) {
+            cerr << "bad option: " << option << ' ' << value << endl;
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Job> jobs;
+    for (auto size = sizes.begin(); size != sizes.end(); ++size)
+        for (auto af = agentFactors.begin(); af != agentFactors.end(); ++af)
+            for (auto rf = resourceFactors.begin(); rf != resourceFactors.end(); ++rf)
+                for (unsigned seed = firstSeed; ; ++seed) {
+                    Job job = { size->first, size->second, *af, *rf, seed };
+                    jobs.push_back(job);
+                    if (seed == lastSeed) break;
+                }
+
+    std::vector<Record> records(jobs.size());
+    ThreadPool pool(numThreads ? numThreads : 1);
+    pool.parallelFor((unsigned) jobs.size(), [&](unsigned i) {
+        records[i] = play(jobs[i], maxRounds);
+    });
+
+    cout << "width,height,agent_factor,resource_factor,seed,rounds,simple,strategic,resources,wall_ms" << endl;
+    for (unsigned i = 0; i < jobs.size(); i++) {
+        const Job &job = jobs[i];
+        const Record &record = records[i];
+        cout << job.width << ',' << job.height << ','
+             << job.agentFactor << ',' << job.resourceFactor << ',' << job.seed << ','
+             << record.rounds << ',' << record.numSimple << ',' << record.numStrategic << ','
+             << record.numResources << ',' << record.wallMs << '\n';
+    }
+
+    return 0;
+}
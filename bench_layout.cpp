@@ -0,0 +1,126 @@
+//
+// Layout benchmark: neighbor access and rounds of the object grid in each cell layout
+//
+// usage: pa4-bench-layout [--sizes WxH,...] [--reps n] [--rounds n] [--seed n]
+//
+// Writes one CSV record per size and layout to standard output, each time the best
+// of reps. Neighbor access is the time of getSurroundings() over every cell of a
+// populated board; rounds are played from the same populated board, so every layout
+// plays the same game.
+// note: getSurroundings() decodes the neighborhood codes, a row-major plane whatever
+// the layout, so neighbor access should come out even across layouts; the layout
+// shows in the moves and the scans of the grid that rounds make
+//
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "Game.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace Gaming;
+
+namespace {
+
+    const char *LAYOUT_NAMES[] = { "row-major", "tiled", "morton" };
+
+    volatile unsigned long sink;
+
+    bool parseSizes(const std::string &arg, std::vector<std::pair<unsigned, unsigned> > &sizes) {
+        std::stringstream ss(arg);
+        std::string item;
+        sizes.clear();
+        while (std::getline(ss, item, ',')) {
+            std::stringstream is(item);
+            unsigned width, height;
+            char x;
+            if (!(is >> width >> x >> height) || x != 'x') return false;
+            if (width < Game::MIN_WIDTH || height < Game::MIN_HEIGHT) return false;
+            sizes.push_back(std::make_pair(width, height));
+        }
+        return !sizes.empty();
+    }
+
+    bool parseNumber(const std::string &arg, unsigned &value) {
+        std::stringstream is(arg);
+        return (is >> value) && is.eof();
+    }
+
+    double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void usage(const char *name) {
+        cerr << "usage: " << name << " [--sizes WxH,...] [--reps n] [--rounds n] [--seed n]" << endl;
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+
+    std::vector<std::pair<unsigned, unsigned> > sizes;
+    sizes.push_back(std::make_pair(256u, 256u));
+    sizes.push_back(std::make_pair(4096u, 64u));
+    unsigned reps = 5, rounds = 10, seed = 2312;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option(argv[i]);
+        if (i + 1 == argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value(argv[++i]);
+
+        bool ok;
+        if (option == "--sizes") ok = parseSizes(value, sizes);
+        else if (option == "--reps") ok = parseNumber(value, reps) && reps > 0;
+        else if (option == "--rounds") ok = parseNumber(value, rounds);
+        else if (option == "--seed") ok = parseNumber(value, seed);
+        else ok = false;
+
+        if (!ok) {
+            cerr << "bad option: " << option << ' ' << value << endl;
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    cout << "width,height,layout,neighbor_ns_per_cell,round_ms" << endl;
+    for (auto size = sizes.begin(); size != sizes.end(); ++size) {
+        for (int l = CellIndex::ROW_MAJOR; l <= CellIndex::MORTON; l++) {
+            double neighborNs = 0, roundMs = 0;
+            for (unsigned rep = 0; rep < reps; rep++) {
+                Game g(size->first, size->second, false, seed);
+                g.setLayout((CellIndex::Layout) l);
+
+                unsigned long sum = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (unsigned x = 0; x < size->second; x++)
+                    for (unsigned y = 0; y < size->first; y++) {
+                        Surroundings s = g.getSurroundings(Position(x, y));
+                        for (int k = 0; k < 9; k++) sum += s.array[k];
+                    }
+                double ns = msSince(start) * 1e6 / ((double) size->first * size->second);
+                if (rep == 0 || ns < neighborNs) neighborNs = ns;
+                sink = sum; // note: keeps the lookups from being optimized away
+
+                unsigned played = 0;
+                start = std::chrono::steady_clock::now();
+                for (; played < rounds && g.getStatus() != Game::OVER; played++) g.round();
+                double ms = played ? msSince(start) / played : 0;
+                if (rep == 0 || ms < roundMs) roundMs = ms;
+            }
+
+            cout << size->first << ',' << size->second << ',' << LAYOUT_NAMES[l] << ','
+                 << neighborNs << ',' << roundMs << '\n';
+        }
+    }
+
+    return 0;
+}
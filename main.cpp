@@ -35,6 +35,8 @@ int main() {
     test_piece_energy(ec, NumIters);
     test_piece_turntaking(ec, NumIters);
     test_piece_interaction(ec, NumIters);
+    test_piece_visit(ec, NumIters);
+    test_piece_mobility(ec, NumIters);
 
     // surroundings tests
     test_surroundings_smoketest(ec);
@@ -49,6 +51,22 @@ int main() {
     test_game_print(ec, NumIters);
     test_game_randomization(ec, NumIters);
     test_game_play(ec, NumIters);
+    test_game_backend(ec, NumIters);
+    test_game_turns(ec, NumIters);
+    test_game_parallel(ec, NumIters);
+    test_game_arena(ec, NumIters);
+    test_game_copy(ec, NumIters);
+    test_game_snapshot(ec, NumIters);
+    test_game_events(ec, NumIters);
+    test_game_synchronous(ec, NumIters);
+    test_game_sparse(ec, NumIters);
+    test_game_layout(ec, NumIters);
+    test_game_live(ec, NumIters);
+    test_game_fastforward(ec, NumIters);
+    test_game_spoilage(ec, NumIters);
+    test_game_neighborhoods(ec, NumIters);
+    test_game_quiescence(ec, NumIters);
+    test_game_moves(ec, NumIters);
 
     return 0;
 }
\ No newline at end of file